@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace randomlevel {
+    // Little-endian helpers for the small binary files the mod persists.
+    class ByteWriter {
+    public:
+        // Grows the buffer and copies into it; inserting from a local array
+        // trips GCC's -Wstringop-overflow once this is inlined.
+        template <class T>
+        void put(T value) {
+            auto offset = m_data.size();
+            m_data.resize(offset + sizeof(T));
+            std::memcpy(m_data.data() + offset, &value, sizeof(T));
+            if constexpr (std::endian::native == std::endian::big) {
+                std::reverse(m_data.begin() + offset, m_data.end());
+            }
+        }
+
+        void putBytes(void const* data, size_t size) {
+            if (size == 0) return;
+            auto offset = m_data.size();
+            m_data.resize(offset + size);
+            std::memcpy(m_data.data() + offset, data, size);
+        }
+
+        std::vector<uint8_t>& data() { return m_data; }
+        std::vector<uint8_t> take() { return std::move(m_data); }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+    class ByteReader {
+    public:
+        explicit ByteReader(std::span<uint8_t const> data) : m_data(data) {}
+
+        template <class T>
+        bool get(T& out) {
+            if (m_offset + sizeof(T) > m_data.size()) return this->fail();
+            uint8_t bytes[sizeof(T)];
+            if constexpr (std::endian::native == std::endian::big) {
+                for (size_t i = 0; i < sizeof(T); i++) bytes[i] = m_data[m_offset + sizeof(T) - 1 - i];
+            }
+            else {
+                std::memcpy(bytes, m_data.data() + m_offset, sizeof(T));
+            }
+            std::memcpy(&out, bytes, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        bool getBytes(void* out, size_t size) {
+            if (m_offset + size > m_data.size()) return this->fail();
+            std::memcpy(out, m_data.data() + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+
+        bool ok() const { return m_ok; }
+        size_t remaining() const { return m_data.size() - m_offset; }
+
+    private:
+        bool fail() {
+            m_ok = false;
+            m_offset = m_data.size();
+            return false;
+        }
+
+        std::span<uint8_t const> m_data;
+        size_t m_offset = 0;
+        bool m_ok = true;
+    };
+}
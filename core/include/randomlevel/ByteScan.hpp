@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace randomlevel {
+    // Delimiter search over server responses, 16 or 32 bytes at a time with
+    // SSE2, AVX2 or NEON when the target has them. The scalar versions give
+    // the same answers and are kept for testing and comparison.
+    size_t findByte(std::string_view text, char byte, size_t from = 0);
+    size_t countByte(std::string_view text, char byte);
+
+    size_t findByteScalar(std::string_view text, char byte, size_t from = 0);
+    size_t countByteScalar(std::string_view text, char byte);
+
+    // "AVX2", "SSE2", "NEON" or "scalar".
+    char const* byteScanBackend();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "IdBitmap.hpp"
+#include "Random.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace randomlevel {
+    // What Chaos probes have learned about level IDs: the ones that came back
+    // missing and the ones that exist. Sampling skips the dead IDs and stays
+    // uniform over everything else, so every probe only spends requests on IDs
+    // that are live or still unknown.
+    class ChaosIdIndex {
+    public:
+        // probed are the IDs that were asked for, found the ones the server
+        // returned. Only record answers that are known to be complete. A miss
+        // above newestID, the newest ID actually seen online, may just not be
+        // uploaded yet, so it is not marked dead.
+        void record(std::span<int const> probed, std::span<int const> found, int newestID, double now);
+        void clear();
+
+        bool isDead(int id) const { return id >= 0 && m_dead.contains((uint32_t)id); }
+        bool isLive(int id) const { return id >= 0 && m_live.contains((uint32_t)id); }
+        uint64_t deadCount() const { return m_dead.size(); }
+        uint64_t liveCount() const { return m_live.size(); }
+
+        // Like sampleDistinct over [min, max] with the dead IDs taken out.
+        std::vector<int> sample(Rng& rng, int min, int max, int count) const;
+
+        bool needsFlush(double now, double flushDelay, int flushBatch) const;
+        int pendingChanges() const { return m_pendingChanges; }
+
+        std::vector<uint8_t> serialize();
+        bool deserialize(std::span<uint8_t const> data);
+
+    private:
+        IdBitmap m_dead;
+        IdBitmap m_live;
+        int m_pendingChanges = 0;
+        double m_firstPendingAt = 0.0;
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ChaosIdIndex.hpp"
+#include "CoroutineRoll.hpp"
+#include "Random.hpp"
+#include "SeenLevels.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace randomlevel {
+    // Rolls level IDs in [128, newest online ID] until one of them exists.
+    // The newest ID is looked up through the Recent tab first when unknown.
+    // With a batch size above 1, each probe asks for that many distinct IDs
+    // at once and picks uniformly among the ones that exist. An ID lookup
+    // answers with at most one page of levels, so batches stop at a page.
+    // With an ID index, probes skip IDs known to be dead; probeAnswered hands
+    // every complete answer to the owner so it can record it there. With a
+    // seen-level set, probes skip seen IDs too and only unseen levels are
+    // picked from an answer.
+    class ChaosRoll : public CoroutineRoll {
+    public:
+        static constexpr int minLevelID = 128;
+        static constexpr int fallbackMaxID = 100000000;
+        static constexpr int maxBatchSize = 10;
+
+        struct Hooks {
+            std::function<void(int)> maxIDFound {};
+            std::function<void(std::vector<int> const& probed, PageResult const& result)> probeAnswered {};
+        };
+
+        ChaosRoll(Rng& rng, int knownMaxID, int batchSize = 1);
+
+        void setHooks(Hooks hooks) { m_hooks = std::move(hooks); }
+        void setIdIndex(ChaosIdIndex const* index) { m_index = index; }
+        void setSeenLevels(SeenLevels const* seen) { m_seen = seen; }
+
+        int maxOnlineID() const { return m_maxOnlineID; }
+        CacheUse cacheUse() const override { return m_cacheUse; }
+
+    protected:
+        RollTask run() override;
+
+    private:
+        PageRequest nextProbe();
+        bool isComplete(PageResult const& result) const;
+
+        Rng& m_rng;
+        Hooks m_hooks;
+        ChaosIdIndex const* m_index = nullptr;
+        SeenLevels const* m_seen = nullptr;
+        std::vector<int> m_probedIDs;
+        int m_maxOnlineID = 0;
+        int m_batchSize = 1;
+        CacheUse m_cacheUse = CacheUse::Miss;
+    };
+}
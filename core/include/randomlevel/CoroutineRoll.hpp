@@ -0,0 +1,85 @@
+#pragma once
+
+#include "RollEngine.hpp"
+
+#include <coroutine>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace randomlevel {
+    // Body of a CoroutineRoll. It co_awaits page results and co_returns the
+    // final step, which must be Done or Abort.
+    class RollTask {
+    public:
+        struct promise_type {
+            std::optional<RollStep> result;
+
+            RollTask get_return_object() { return RollTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_value(RollStep step) { result = std::move(step); }
+            void unhandled_exception() noexcept;
+        };
+
+        RollTask() = default;
+        RollTask(RollTask&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+        RollTask& operator=(RollTask&& other) noexcept;
+        ~RollTask();
+
+        bool done() const { return !m_handle || m_handle.done(); }
+        void resume() { if (!this->done()) m_handle.resume(); }
+        std::optional<RollStep>& result() { return m_handle.promise().result; }
+
+    private:
+        explicit RollTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    // A roll written as straight-line code instead of a state machine:
+    // run() co_awaits fetch(), and every await becomes one Fetch step for
+    // the driver. The coroutine frame belongs to the engine, so destroying
+    // the engine mid-roll cancels it.
+    //
+    // Chaos and local-index rolls use it. The discovery strategies stay
+    // state machines: they share DiscoveryEngine's target phase and resume
+    // checkpoints, and porting one alone would split that base. There is no
+    // delay await, since the driver's one timer slot paces requests and a
+    // sleep would need a second one, and no concurrent await, since no roll
+    // has two stages to overlap (Smart rolls never need the newest level ID).
+    class CoroutineRoll : public RollEngine {
+    public:
+        RollStep start() final;
+        RollStep onResult(PageResult const& result) final;
+        std::string_view phaseName() const final { return m_phase; }
+
+    protected:
+        struct FetchAwaiter {
+            CoroutineRoll& roll;
+            PageRequest request;
+            float delay;
+
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<>) { roll.await(std::move(request), delay); }
+            PageResult await_resume() { return std::move(*roll.m_result); }
+        };
+
+        virtual RollTask run() = 0;
+
+        FetchAwaiter fetch(PageRequest request, float delay) {
+            return { *this, std::move(request), delay };
+        }
+        void setPhase(std::string_view phase) { m_phase = phase; }
+
+    private:
+        void await(PageRequest request, float delay);
+        RollStep takeStep();
+
+        RollTask m_task;
+        std::optional<RollStep> m_step;
+        std::optional<PageRequest> m_awaited;
+        std::optional<PageResult> m_result;
+        std::string_view m_phase = "Idle";
+    };
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Random.hpp"
+#include "RollEngine.hpp"
+#include "SeenLevels.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace randomlevel {
+    // What the probes of an unfinished discovery have shown: page lastFull
+    // holds 10 levels and page firstEmpty holds none.
+    struct DiscoveryCheckpoint {
+        int lastFull = -1;
+        std::optional<int> firstEmpty;
+
+        bool operator==(DiscoveryCheckpoint const&) const = default;
+    };
+
+    // cachedMaxPage is where this filter is expected to end, going by its own
+    // earlier results. lowerPage and upperPage bound the max page from
+    // related filters: page lowerPage has levels and nothing lies past
+    // upperPage. checkpoint is where an earlier discovery of this filter
+    // stopped.
+    struct DiscoveryHints {
+        std::optional<int> cachedMaxPage {};
+        int lowerPage = 0;
+        std::optional<int> upperPage {};
+        std::optional<DiscoveryCheckpoint> checkpoint {};
+    };
+
+    enum class DiscoveryStrategy {
+        Bisect,
+        Gallop,
+        Parallel
+    };
+
+    // Shared half of every Smart roll: once a strategy knows the last page
+    // and how many levels it holds, pick a uniform global index and fetch it.
+    // With a pick count above 1 that many distinct indices are drawn and each
+    // page they land on is fetched once, all at the same time. Pages already
+    // downloaded during the roll are served without a request. An empty
+    // target page means the count was stale, so the strategy is restarted
+    // from scratch. Every probe that narrows the bracket is reported through
+    // the checkpointed hook, so an interrupted discovery can be resumed.
+    // With a seen-level set, a pick that lands on a seen level moves to an
+    // unseen one on the same page, or is redrawn across all pages when the
+    // page has none left; after maxRedraws it takes the closest unseen level
+    // on a page already fetched, and a seen one only when none is left.
+    class DiscoveryEngine : public RollEngine {
+    public:
+        struct Hooks {
+            std::function<void(int)> maxPageFound {};
+            std::function<void()> cacheInvalidated {};
+            std::function<void(DiscoveryCheckpoint const&)> checkpointed {};
+        };
+
+        DiscoveryEngine(Rng& rng, DiscoveryHints hints);
+
+        static constexpr int maxPicks = 100;
+        static constexpr int maxRedraws = 3;
+
+        void setHooks(Hooks hooks) { m_hooks = std::move(hooks); }
+        void setSeenLevels(SeenLevels const* seen) { m_seen = seen; }
+        void setPickCount(int count) { m_pickCount = std::clamp(count, 1, maxPicks); }
+
+        RollStep start() final;
+        RollStep onResult(PageResult const& result) final;
+        std::string_view phaseName() const final;
+        CacheUse cacheUse() const override { return m_cacheUse; }
+        int invalidations() const override { return m_invalidations; }
+
+        bool fetchingTarget() const { return m_fetchingTarget; }
+        std::vector<LevelSlot> const& targets() const { return m_targets; }
+
+    protected:
+        static constexpr float safeDelay = 0.5f;
+        static constexpr float searchDelay = 0.75f;
+        static constexpr float retryDelay = 1.0f;
+        static constexpr float targetDelay = 0.1f;
+        static constexpr int maxRetries = 5;
+        static constexpr int minCorrection = 4;
+
+        virtual RollStep startDiscovery() = 0;
+        virtual RollStep onDiscoveryResult(PageResult const& result) = 0;
+        virtual std::string_view discoveryPhaseName() const = 0;
+
+        RollStep prepareTarget(int maxPageInclusive, int levelsOnMaxPage);
+        RollStep retryOrAbort(RollStep retry);
+
+        // The bracket the hints give, in last-full / first-empty terms.
+        int hintedLastFull() const;
+        int hintedFirstEmpty(int fallback) const;
+        // The highest page the hints say has levels.
+        int hintedLowPage() const { return std::max(m_hints.lowerPage, this->hintedLastFull()); }
+
+        // How far from the cached page a peek may find the end and still be
+        // corrected around it; a bigger miss starts fresh discovery.
+        static int correctionPages(int cachedPage) { return std::max(minCorrection, cachedPage / 16); }
+
+        // A page that is FailedOrEmpty twice in a row is taken as empty.
+        bool failedBefore(int page);
+        static PageRequest pageRequest(int page);
+        static RollStep fetchPage(int page, float delay);
+
+        Rng& m_rng;
+        DiscoveryHints m_hints;
+
+    private:
+        void recordProgress(PageResult const& result);
+        RollStep onTargetResult(PageResult const& result);
+        RollStep resolveTargets();
+        RollStep restartDiscovery();
+        std::optional<int> unseenSlot(std::vector<int> const& levelIDs, LevelSlot target, std::vector<LevelSlot> const& picks);
+        std::optional<LevelSlot> closestSlot(LevelSlot target, std::vector<LevelSlot> const& picks, bool unseenOnly) const;
+
+        Hooks m_hooks;
+        SeenLevels const* m_seen = nullptr;
+        DiscoveryCheckpoint m_progress;
+        // Level IDs of every page fetched during the roll.
+        std::map<int, std::vector<int>> m_pageLevels;
+        std::set<int> m_failedPages;
+        bool m_fetchingTarget = false;
+        int m_pickCount = 1;
+        std::vector<LevelSlot> m_targets;
+        long long m_totalLevels = 0;
+        int m_redraws = 0;
+        std::set<int> m_pendingPages;
+        bool m_targetsStale = false;
+        int m_retryCount = 0;
+        CacheUse m_cacheUse = CacheUse::Miss;
+        int m_invalidations = 0;
+    };
+
+    // parallelWidth is the number of concurrent probes per round for the
+    // Parallel strategy and is ignored by the others.
+    std::unique_ptr<DiscoveryEngine> makeDiscovery(
+        DiscoveryStrategy strategy, Rng& rng, DiscoveryHints hints, int parallelWidth = 3
+    );
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "FilterKey.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace randomlevel {
+    // pagesPerDay is the growth rate fitted to the pages rolls have found
+    // since observedSince, so a count can be carried forward between rolls
+    // instead of rediscovered.
+    struct FilterCountEntry {
+        int maxPage = 0;
+        double updatedAt = 0.0;
+        float pagesPerDay = 0.0f;
+        double observedSince = 0.0;
+
+        // This entry after a roll found maxPage at `now`. The rate is a
+        // time-weighted average: the old rate weighs as much as the history
+        // behind it, between one and seven days' worth.
+        FilterCountEntry observe(int maxPage, double now) const;
+        // The max page expected at `now`, extrapolated at most 30 days.
+        // Infinite entries are not extrapolated.
+        int predictedPage(double now) const;
+    };
+
+    // What related cached keys say about a key's max page. A broader key's
+    // page caps it, a narrower key's page is a floor, and a narrower key that
+    // runs into the page 1000 glitch makes this one infinite too.
+    struct FilterBounds {
+        int lowerPage = 0;
+        std::optional<int> upperPage;
+        bool infinite = false;
+    };
+
+    // Max page per filter key, bounded by an LRU cap. Changes are only
+    // counted here; the owner decides when to serialize (see needsFlush).
+    class FilterCountCache {
+    public:
+        explicit FilterCountCache(size_t capacity = 256);
+
+        std::optional<FilterCountEntry> find(FilterKey const& key);
+        void store(FilterKey const& key, FilterCountEntry entry);
+        void erase(FilterKey const& key, double now);
+        // Stores a max page a roll found, refitting the key's growth rate.
+        void observe(FilterKey const& key, int maxPage, double now);
+        // Only entries updated within maxAge seconds are trusted,
+        // and the LRU order is left alone.
+        FilterBounds bounds(FilterKey const& key, double now, double maxAge) const;
+        void clear();
+
+        size_t size() const { return m_index.size(); }
+        size_t capacity() const { return m_capacity; }
+        void setCapacity(size_t capacity);
+
+        // Write-behind bookkeeping: true once changes have been pending for
+        // flushDelay seconds or flushBatch changes have piled up.
+        bool needsFlush(double now, double flushDelay, int flushBatch) const;
+        int pendingChanges() const { return m_pendingChanges; }
+
+        std::vector<uint8_t> serialize();
+        bool deserialize(std::span<uint8_t const> data);
+
+    private:
+        struct Node {
+            FilterKey key;
+            FilterCountEntry entry;
+        };
+
+        void markDirty(double now);
+        void evict();
+
+        size_t m_capacity;
+        std::list<Node> m_order;
+        std::unordered_map<FilterKey, std::list<Node>::iterator> m_index;
+        int m_pendingChanges = 0;
+        double m_firstPendingAt = 0.0;
+    };
+}
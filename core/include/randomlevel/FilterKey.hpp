@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace randomlevel {
+    enum FilterFlag : uint16_t {
+        StarFilter = 1 << 0,
+        NoStarFilter = 1 << 1,
+        FeaturedFilter = 1 << 2,
+        EpicFilter = 1 << 3,
+        LegendaryFilter = 1 << 4,
+        MythicFilter = 1 << 5,
+        CompletedFilter = 1 << 6,
+        UncompletedFilter = 1 << 7,
+        CustomSongFilter = 1 << 8,
+        OriginalFilter = 1 << 9,
+        TwoPlayerFilter = 1 << 10,
+        CoinsFilter = 1 << 11,
+    };
+
+    // The raw search fields, as read off a GJSearchObject.
+    struct FilterFields {
+        std::string_view difficulty {};
+        std::string_view length {};
+        std::string_view query {};
+        int demonFilter = 0;
+        int songID = 0;
+        uint16_t flags = 0;
+    };
+
+    // Fixed-size identity of a filter set. Difficulty and length lists
+    // ("1,2,5", "-") become bitmasks where 0 means unconstrained, and the
+    // free-text query is reduced to a hash.
+    struct FilterKey {
+        uint16_t difficultyMask = 0;
+        uint8_t lengthMask = 0;
+        uint8_t demonFilter = 0;
+        uint16_t flags = 0;
+        int32_t songID = 0;
+        uint64_t queryHash = 0;
+
+        static FilterKey from(FilterFields const& fields);
+
+        // True when every level this key matches also matches `other`, so its
+        // page count can be no larger. Rating filters are alternatives to
+        // each other, so only an identical rating set counts.
+        bool narrows(FilterKey const& other) const;
+
+        bool operator==(FilterKey const&) const = default;
+        uint64_t hash() const;
+    };
+
+    // Bitmask of a comma-separated value list, value v setting bit (v + offset).
+    // "-" and empty lists give 0.
+    uint32_t parseFilterList(std::string_view list, int offset);
+    uint64_t hashBytes(std::string_view bytes);
+}
+
+template <>
+struct std::hash<randomlevel::FilterKey> {
+    size_t operator()(randomlevel::FilterKey const& key) const noexcept {
+        return static_cast<size_t>(key.hash());
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "DiscoveryEngine.hpp"
+
+#include <optional>
+
+namespace randomlevel {
+    // Page discovery that starts from the best estimate of the last page (the
+    // cached page, or the reported total when the server clamps it) and gallops
+    // away from it with doubling steps until the end is bracketed, then
+    // bisects the bracket. An end far from the cached page restarts from
+    // page 0 instead. A partially filled page ends the search at once,
+    // and a full page next to an empty one is already an exact count, so there
+    // is no separate exact-count fetch at the end.
+    class GallopDiscovery : public DiscoveryEngine {
+    public:
+        enum class GallopPhase {
+            Idle,
+            CheckTotal,
+            GlitchCheck,
+            Peek,
+            GallopUp,
+            GallopDown,
+            Bisect
+        };
+
+        GallopDiscovery(Rng& rng, DiscoveryHints hints);
+
+        GallopPhase phase() const { return m_phase; }
+
+    protected:
+        RollStep startDiscovery() override;
+        RollStep onDiscoveryResult(PageResult const& result) override;
+        std::string_view discoveryPhaseName() const override;
+
+    private:
+        static constexpr int glitchPage = 1000;
+
+        RollStep onPage(PageResult const& result);
+        RollStep finiteSearch();
+        RollStep next();
+        bool beyondCorrection(int page) const;
+        RollStep restartFresh();
+        RollStep probe(GallopPhase phase, int page, float delay);
+
+        GallopPhase m_phase = GallopPhase::Idle;
+        int m_page = 0;
+        int m_step = 1;
+        int m_lastFull = -1;
+        int m_firstEmpty = glitchPage + 1;
+        std::optional<int> m_estimate;
+        std::optional<int> m_cachedPage;
+    };
+}
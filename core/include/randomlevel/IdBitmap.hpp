@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Binary.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace randomlevel {
+    // Compressed set of 32-bit IDs in the roaring layout: one container per
+    // 65536-ID block, stored as a sorted array while sparse and as a plain
+    // bitmap once it holds more than 4096 IDs.
+    class IdBitmap {
+    public:
+        bool add(uint32_t id);
+        bool remove(uint32_t id);
+        bool contains(uint32_t id) const;
+        void clear();
+
+        uint64_t size() const;
+        // Members that are <= id.
+        uint64_t rank(uint32_t id) const;
+        // The k-th (0-based) value in [min, max] that is not a member.
+        uint32_t selectAbsent(uint32_t min, uint32_t max, uint64_t k) const;
+
+        void write(ByteWriter& out) const;
+        bool read(ByteReader& in);
+
+    private:
+        static constexpr uint32_t arrayLimit = 4096;
+        static constexpr uint32_t bitmapWords = 1024;
+
+        struct Container {
+            uint16_t key = 0;
+            uint32_t cardinality = 0;
+            std::vector<uint16_t> array;
+            std::vector<uint64_t> bits;
+
+            bool isBitmap() const { return !bits.empty(); }
+            bool contains(uint16_t low) const;
+            bool add(uint16_t low);
+            bool remove(uint16_t low);
+            uint32_t rank(uint16_t low) const;
+        };
+
+        Container* find(uint16_t key);
+        Container const* find(uint16_t key) const;
+
+        std::vector<Container> m_containers;
+    };
+}
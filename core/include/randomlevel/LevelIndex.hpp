@@ -0,0 +1,101 @@
+#pragma once
+
+#include "FilterKey.hpp"
+#include "LevelResponse.hpp"
+#include "MappedFile.hpp"
+#include "Random.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace randomlevel {
+    // A level reduced to what the search filters look at, in the filters'
+    // own terms: difficulty is the search value (-3 auto, -2 demon, -1 N/A,
+    // 1-5), demon is the demon filter value (1-5, 0 if not a demon) and flags
+    // holds the FilterFlag bits the level satisfies. from() leaves out the
+    // original, two-player and coins bits, which LevelFields does not carry.
+    struct IndexedLevel {
+        int levelID = 0;
+        int8_t difficulty = -1;
+        uint8_t demon = 0;
+        uint8_t length = 0;
+        uint16_t flags = 0;
+        int audioTrack = 0;
+        int customSong = 0;
+
+        static IndexedLevel from(LevelFields const& fields);
+        bool matches(FilterKey const& key) const;
+        bool operator==(IndexedLevel const&) const = default;
+    };
+
+    // CSV level dump with a header row. Columns are named after LevelFields
+    // in snake case (id, difficulty, demon, auto, demon_difficulty, length,
+    // stars, featured, epic, song, custom_song); only id is required.
+    std::optional<std::vector<IndexedLevel>> parseLevelDump(std::string_view csv);
+
+    // Offline answer to Smart RNG filters. The file is columnar: the level
+    // IDs and song columns, then one bitmap over all rows per filterable
+    // value, so a filter is a handful of ANDs and ORs over the mapped words.
+    // Levels seen later go into an in-memory overlay that shadows their old
+    // row until the next serialize() merges both.
+    class LevelIndex {
+    public:
+        static std::vector<uint8_t> build(std::vector<IndexedLevel> levels);
+
+        bool open(std::filesystem::path const& path);
+        void close();
+        bool isOpen() const { return m_file.isOpen(); }
+
+        // Completed/uncompleted, original, two-player and coins filters and
+        // text queries need data the index does not have.
+        static bool canAnswer(FilterKey const& key);
+
+        size_t size() const;
+        uint64_t count(FilterKey const& key) const;
+        std::optional<int> pick(FilterKey const& key, Rng& rng) const;
+
+        void update(IndexedLevel const& level);
+        // For levels the server no longer has.
+        void remove(int levelID);
+        int pendingChanges() const { return m_pendingChanges; }
+
+        // Updates and removals since the file was opened, to carry over onto
+        // a rebuilt file.
+        struct Changes {
+            std::vector<IndexedLevel> updated;
+            std::vector<int> removed;
+        };
+        Changes changes() const;
+        void apply(Changes const& changes);
+
+        // Merged base and overlay, ready to replace the file.
+        std::vector<uint8_t> serialize();
+
+    private:
+        bool attach(std::span<uint8_t const> data);
+        std::optional<size_t> findRow(int levelID) const;
+        IndexedLevel baseRow(size_t row) const;
+        bool hasBit(int bitmap, size_t row) const;
+        std::vector<uint64_t> matchBase(FilterKey const& key) const;
+
+        MappedFile m_file;
+        uint32_t m_rows = 0;
+        uint32_t m_words = 0;
+        int32_t const* m_ids = nullptr;
+        int32_t const* m_audioTracks = nullptr;
+        int32_t const* m_customSongs = nullptr;
+        uint64_t const* m_bitmaps = nullptr;
+
+        std::vector<uint64_t> m_shadowed;
+        std::vector<IndexedLevel> m_overlay;
+        std::unordered_map<int, size_t> m_overlayRows;
+        std::unordered_set<int> m_removed;
+        int m_pendingChanges = 0;
+    };
+}
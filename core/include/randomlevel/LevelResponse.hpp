@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ByteScan.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace randomlevel {
+    // Offsets point into the response the page was parsed from, so a summary
+    // is only meaningful while that buffer is alive.
+    struct TextSpan {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+
+        std::string_view in(std::string_view text) const { return text.substr(offset, length); }
+    };
+
+    struct LevelSummary {
+        int levelID = 0;
+        int playerID = 0;
+        int downloads = 0;
+        int likes = 0;
+        TextSpan name;
+        TextSpan raw;
+    };
+
+    struct CreatorSummary {
+        int playerID = 0;
+        int accountID = 0;
+        TextSpan name;
+    };
+
+    struct LevelPage {
+        std::vector<LevelSummary> levels;
+        std::vector<CreatorSummary> creators;
+        int total = 0;
+        int offset = 0;
+        int amount = 0;
+
+        CreatorSummary const* creator(int playerID) const;
+    };
+
+    // The searchable fields of a level, with the values the server uses
+    // (difficulty 0-50 in steps of 10, GD's demon difficulty codes, audio
+    // track 0-based).
+    struct LevelFields {
+        int levelID = 0;
+        int difficulty = 0;
+        bool demon = false;
+        bool autoLevel = false;
+        int demonDifficulty = 0;
+        int length = 0;
+        int stars = 0;
+        int featureScore = 0;
+        int epic = 0;
+        int audioTrack = 0;
+        int customSong = 0;
+    };
+
+    // Section and record boundaries of a response, found without allocating
+    // or decoding a level. The views point into the scanned response.
+    struct PageScan {
+        std::string_view levels;
+        std::string_view creators;
+        int count = 0;
+        int total = 0;
+        int offset = 0;
+        int amount = 0;
+
+        // The index-th level entry, or an empty view past the end.
+        std::string_view record(int index) const;
+
+        template <class Visit>
+        void forEachRecord(Visit&& visit) const {
+            size_t start = 0;
+            for (int i = 0; i < count; i++) {
+                auto end = findByte(levels, '|', start);
+                visit(levels.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+    };
+
+    // Same acceptance rules as parseLevelPage for the page as a whole, but
+    // the levels are only counted, not checked.
+    std::optional<PageScan> scanLevelPage(std::string_view response);
+
+    // The raw value of one key in a level entry, decoded on demand.
+    std::optional<std::string_view> levelField(std::string_view entry, std::string_view key);
+    std::optional<int> levelIntField(std::string_view entry, std::string_view key);
+
+    // One "key:value:key:value" level entry, as found in LevelSummary::raw.
+    std::optional<LevelFields> parseLevelFields(std::string_view entry);
+
+    // Parses a getGJLevels21 response ("levels#creators#songs#page info#hash")
+    // without copying any strings. "-1" is the server's answer for no results
+    // and gives an empty page; anything else unreadable gives nullopt.
+    std::optional<LevelPage> parseLevelPage(std::string_view response);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "FilterKey.hpp"
+#include "CoroutineRoll.hpp"
+#include "LevelIndex.hpp"
+#include "Random.hpp"
+#include "SeenLevels.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace randomlevel {
+    // Smart roll answered by a LevelIndex: the level is picked locally and
+    // the only request looks its ID up so it can be opened. IDs that are
+    // gone from the server are skipped and another one is picked, and so,
+    // without costing a request, are IDs in the seen-level set.
+    class LocalIndexRoll : public CoroutineRoll {
+    public:
+        static constexpr int maxPicks = 5;
+        static constexpr int maxSeenDraws = 20;
+
+        struct Hooks {
+            // When the roll ends, with the picked IDs the server answered
+            // cleanly without a level, so the owner can drop them.
+            std::function<void(std::vector<int> const&)> levelsMissing {};
+        };
+
+        LocalIndexRoll(Rng& rng, LevelIndex const& index, FilterKey key);
+
+        void setHooks(Hooks hooks) { m_hooks = std::move(hooks); }
+        void setSeenLevels(SeenLevels const* seen) { m_seen = seen; }
+
+    protected:
+        RollTask run() override;
+
+    private:
+        RollStep finish(RollStep step);
+
+        Hooks m_hooks;
+        Rng& m_rng;
+        LevelIndex const& m_index;
+        FilterKey m_key;
+        SeenLevels const* m_seen = nullptr;
+        std::vector<int> m_missing;
+    };
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace randomlevel {
+    // Read-only memory map of a whole file. Move-only; the view stays valid
+    // until close() or destruction.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { this->close(); }
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+
+        bool open(std::filesystem::path const& path);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        std::span<uint8_t const> data() const { return { m_data, m_size }; }
+
+    private:
+        uint8_t const* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+}
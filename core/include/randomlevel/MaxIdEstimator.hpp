@@ -0,0 +1,40 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+namespace randomlevel {
+    struct IdObservation {
+        double time = 0.0;
+        int maxID = 0;
+    };
+
+    // Tracks the newest level ID seen over time and fits an upload rate to
+    // it, so the newest online ID can be predicted without asking the Recent
+    // tab. Observations closer together than minSpacing are merged, and only
+    // the last maxHistory are kept for the fit. A prediction never runs more
+    // than maxLead IDs past the newest observed ID, so one bad fit cannot
+    // send rolls far beyond the real top.
+    class MaxIdEstimator {
+    public:
+        static constexpr int maxHistory = 32;
+        static constexpr double minSpacing = 3600.0;
+        static constexpr double maxExtrapolation = 90.0 * 86400.0;
+        static constexpr int maxLead = 200000;
+
+        // Any level ID seen at `now`; only IDs above the newest known one count.
+        bool observe(int levelID, double now);
+        std::optional<int> predict(double now) const;
+
+        // Fitted IDs per second, 0 until observations span at least minSpacing.
+        double uploadRate() const { return m_rate; }
+        std::vector<IdObservation> const& history() const { return m_history; }
+        void restore(std::vector<IdObservation> history);
+
+    private:
+        void fit();
+
+        std::vector<IdObservation> m_history;
+        double m_rate = 0.0;
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace randomlevel {
+    enum class RequestKind { FilterPage, IdLookup, Recent };
+
+    struct PageRequest {
+        RequestKind kind = RequestKind::FilterPage;
+        int page = 0;
+        std::vector<int> ids;
+    };
+
+    // FailedOrEmpty is the server's "-1": usually a page without results, but
+    // the server sometimes answers a request it failed to serve the same way.
+    // A request that never got an answer is Failed.
+    enum class FetchStatus { Ok, Failed, FailedOrEmpty };
+
+    struct PageResult {
+        FetchStatus status = FetchStatus::Failed;
+        int page = 0;
+        int total = 0;
+        std::vector<int> levelIDs;
+
+        bool ok() const { return status == FetchStatus::Ok; }
+        bool maybeEmpty() const { return status == FetchStatus::FailedOrEmpty; }
+        int count() const { return static_cast<int>(levelIDs.size()); }
+    };
+
+    // Answers one getGJLevels-style request. Implementations may call back
+    // synchronously (local data) or later (network, simulated latency).
+    class PageFetcher {
+    public:
+        using Callback = std::function<void(PageResult)>;
+
+        virtual ~PageFetcher() = default;
+        virtual void fetch(PageRequest const& request, Callback callback) = 0;
+        virtual void cancel() {}
+
+        // Answers a request from pages already on the device, if a fresh
+        // enough copy exists. Such answers cost no request and are not paced.
+        virtual std::optional<PageResult> lookup(PageRequest const&) { return std::nullopt; }
+    };
+
+    class Timer {
+    public:
+        virtual ~Timer() = default;
+        virtual double now() const = 0;
+        virtual void after(double seconds, std::function<void()> callback) = 0;
+        virtual void cancel() = 0;
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "DiscoveryEngine.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace randomlevel {
+    // Page discovery in rounds of concurrent probes. A cold roll opens with
+    // page 0 and the glitch page together (a warm one just peeks the cached
+    // page), then each round either ladders away from the one known side with
+    // doubling steps or splits the bracket into width + 1 parts. That costs
+    // more requests than a bisection but far fewer round trips.
+    class ParallelDiscovery : public DiscoveryEngine {
+    public:
+        enum class ParallelPhase {
+            Idle,
+            Opening,
+            Ladder,
+            Split
+        };
+
+        static constexpr int maxWidth = 8;
+
+        ParallelDiscovery(Rng& rng, DiscoveryHints hints, int width);
+
+        ParallelPhase phase() const { return m_phase; }
+
+    protected:
+        RollStep startDiscovery() override;
+        RollStep onDiscoveryResult(PageResult const& result) override;
+        std::string_view discoveryPhaseName() const override;
+
+    private:
+        static constexpr int glitchPage = 1000;
+
+        RollStep round(ParallelPhase phase, std::vector<int> pages, float delay);
+        RollStep evaluate();
+        std::vector<int> ladderUp() const;
+        std::vector<int> ladderDown() const;
+        std::vector<int> around(int page) const;
+        std::vector<int> split() const;
+
+        int m_width;
+        ParallelPhase m_phase = ParallelPhase::Idle;
+        std::vector<int> m_pages;
+        std::vector<PageResult> m_results;
+        int m_lastFull = -1;
+        int m_firstEmpty = glitchPage + 1;
+        std::optional<int> m_estimate;
+    };
+}
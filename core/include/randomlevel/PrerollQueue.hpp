@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <string>
+
+namespace randomlevel {
+    // Small FIFO of already-resolved rolls for one key (a filter key, or the
+    // Chaos pool). Changing the key or exceeding maxAge drops entries.
+    template <class T, class Key = std::string>
+    class PrerollQueue {
+    public:
+        PrerollQueue(size_t capacity, double maxAge) : m_capacity(capacity), m_maxAge(maxAge) {}
+
+        void configure(size_t capacity, double maxAge) {
+            m_capacity = capacity;
+            m_maxAge = maxAge;
+            while (m_entries.size() > m_capacity) m_entries.pop_front();
+        }
+
+        Key const& key() const { return m_key; }
+
+        void setKey(Key const& key) {
+            if (key == m_key) return;
+            m_key = key;
+            m_entries.clear();
+        }
+
+        void push(T value, double now) {
+            this->expire(now);
+            if (m_entries.size() >= m_capacity) return;
+            m_entries.push_back({ std::move(value), now });
+        }
+
+        std::optional<T> pop(Key const& key, double now) {
+            if (key != m_key) return std::nullopt;
+            this->expire(now);
+            if (m_entries.empty()) return std::nullopt;
+
+            auto value = std::move(m_entries.front().value);
+            m_entries.pop_front();
+            return value;
+        }
+
+        bool wantsMore(double now) {
+            this->expire(now);
+            return m_entries.size() < m_capacity;
+        }
+
+        size_t size() const { return m_entries.size(); }
+        void clear() { m_entries.clear(); }
+
+    private:
+        struct Entry {
+            T value;
+            double createdAt;
+        };
+
+        void expire(double now) {
+            while (!m_entries.empty() && now - m_entries.front().createdAt > m_maxAge) {
+                m_entries.pop_front();
+            }
+        }
+
+        size_t m_capacity;
+        double m_maxAge;
+        Key m_key{};
+        std::deque<Entry> m_entries;
+    };
+}
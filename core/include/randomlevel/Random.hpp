@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace randomlevel {
+    class Rng {
+    public:
+        Rng() : m_engine(std::random_device{}()) {}
+        explicit Rng(uint64_t seed) : m_engine(seed) {}
+
+        int uniformInt(int min, int max) {
+            std::uniform_int_distribution<int> dist(min, max);
+            return dist(m_engine);
+        }
+
+        double uniformReal() {
+            std::uniform_real_distribution<double> dist(0.0, 1.0);
+            return dist(m_engine);
+        }
+
+        std::mt19937_64& engine() { return m_engine; }
+
+    private:
+        std::mt19937_64 m_engine;
+    };
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FilterKey.hpp"
+#include "PageFetcher.hpp"
+#include "Random.hpp"
+#include "SimulatedServer.hpp"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace randomlevel {
+    // getGJLevels21 responses of one filter, per page in the order they were
+    // received. The text form has one "page<TAB>body" line per response and
+    // '#' comments; an empty body is a request that failed, "-1" is the
+    // server's answer for no results. A "# key" comment, written by the
+    // mod's capture, names the filter the responses belong to.
+    struct ResponseFixture {
+        std::string name;
+        std::map<int, std::vector<std::string>> responses;
+    };
+
+    std::optional<ResponseFixture> parseFixture(std::string_view text, std::string name);
+    std::string fixtureLine(int page, std::string_view body);
+    std::string fixtureKeyLine(FilterKey const& key);
+
+    struct ReplayConfig {
+        double latency = 0.25;
+        double latencyJitter = 0.05;
+        bool emptyAsFailure = false;
+        uint64_t seed = 1;
+    };
+
+    // Answers filter pages from a fixture. Each captured response is replayed
+    // once, in order, failures included; after that a page keeps its last
+    // good answer. Pages never captured are filled in from the shape the
+    // captured ones imply: every page before the last one with levels is
+    // full, the pages after it are empty, and levels on page 1000 or later
+    // mean the page-1000 glitch, where every page is full.
+    class ReplayServer : public PageFetcher {
+    public:
+        ReplayServer(SimClock& clock, ResponseFixture fixture, ReplayConfig config);
+
+        void fetch(PageRequest const& request, Callback callback) override;
+        void cancel() override { m_generation++; }
+
+        // Rewinds every page to its first captured response.
+        void rewind();
+
+        int requestCount() const { return m_requestCount; }
+        int lastPage() const { return m_lastPage; }
+        int lastPageCount() const { return m_lastCount; }
+        bool infinite() const { return m_infinite; }
+
+    private:
+        struct Page {
+            std::vector<std::string> bodies;
+            size_t next = 0;
+            std::optional<PageResult> lastGood;
+        };
+
+        PageResult respond(int page);
+        PageResult fromBody(int page, std::string_view body) const;
+        PageResult synthesize(int page) const;
+
+        SimClock& m_clock;
+        ReplayConfig m_config;
+        Rng m_rng;
+        std::map<int, Page> m_pages;
+        int m_lastPage = -1;
+        int m_lastCount = 0;
+        int m_total = 0;
+        bool m_infinite = false;
+        int m_requestCount = 0;
+        uint64_t m_generation = 0;
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+namespace randomlevel {
+    struct SchedulerConfig {
+        double initialRate = 1.0;
+        double minRate = 0.2;
+        double maxRate = 1.5;
+        // A whole discovery fits in the bucket; with maxRate on top it stays
+        // under 60 requests in 30 seconds.
+        double burst = 10.0;
+        double additiveIncrease = 0.05;
+        double multiplicativeDecrease = 0.5;
+        double slowDecrease = 0.85;
+        double latencyTarget = 1.5;
+        double baseCooldown = 0.5;
+        double maxCooldown = 60.0;
+    };
+
+    struct SchedulerState {
+        double rate = 0.0;
+        double tokens = 0.0;
+        double pausedUntil = 0.0;
+        double savedAt = 0.0;
+    };
+
+    // Token bucket shared by every request a roll makes. The refill rate
+    // grows additively while responses are fast and successful, and is cut
+    // multiplicatively on failures or slow responses. Consecutive failures
+    // also pause the bucket with an exponentially growing cooldown.
+    class RequestScheduler {
+    public:
+        explicit RequestScheduler(SchedulerConfig config = {});
+
+        // Takes a token and returns how long to wait before sending.
+        double reserve(double now);
+        void onSuccess(double now, double latency);
+        void onFailure(double now);
+
+        double rate() const { return m_rate; }
+        double pausedUntil() const { return m_pausedUntil; }
+        SchedulerConfig& config() { return m_config; }
+
+        SchedulerState save(double now) const;
+        void restore(SchedulerState const& state, double now);
+
+    private:
+        void refill(double now);
+
+        SchedulerConfig m_config;
+        double m_rate;
+        double m_tokens;
+        double m_lastRefill = 0.0;
+        double m_pausedUntil = 0.0;
+        int m_consecutiveFailures = 0;
+    };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "PageFetcher.hpp"
+#include "RequestScheduler.hpp"
+#include "RollEngine.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace randomlevel {
+    // paced is the pacing delay spent right before the request went out.
+    // Requests still in flight when the roll ended are left unanswered.
+    struct RequestRecord {
+        std::string phase;
+        RequestKind kind = RequestKind::FilterPage;
+        int page = 0;
+        double sentAt = 0.0;
+        double answeredAt = 0.0;
+        double paced = 0.0;
+        FetchStatus status = FetchStatus::Failed;
+        bool local = false;
+        bool answered = false;
+    };
+
+    struct RollStats {
+        int requests = 0;
+        int localHits = 0;
+        int failures = 0;
+        double startTime = 0.0;
+        double endTime = 0.0;
+        double delayTime = 0.0;
+        std::map<std::string, int> requestsByPhase;
+        CacheUse cache = CacheUse::None;
+        int invalidations = 0;
+        std::vector<RequestRecord> requestLog;
+
+        double elapsed() const { return endTime - startTime; }
+    };
+
+    struct RollOutcome {
+        bool success = false;
+        int page = 0;
+        int slot = 0;
+        std::vector<LevelSlot> picks;
+        std::string reason;
+        RollStats stats;
+    };
+
+    // Runs one RollEngine against a fetcher. Without a scheduler each step
+    // waits the fixed delay the engine asks for and the rest of a batch goes
+    // out right after; with one, every request is paced by the scheduler's
+    // token bucket and the engine's delay is ignored. Requests the fetcher can
+    // answer locally skip both.
+    class RollDriver {
+    public:
+        using Completion = std::function<void(RollOutcome const&)>;
+
+        RollDriver(PageFetcher& fetcher, Timer& timer);
+        ~RollDriver() { this->cancel(); }
+
+        void run(RollEngine& engine, Completion completion);
+        void cancel();
+        bool running() const { return m_engine != nullptr; }
+
+        void setScheduler(RequestScheduler* scheduler) { m_scheduler = scheduler; }
+
+    private:
+        void apply(RollStep step);
+        void pump(double fixedDelay);
+        void issueNext();
+        bool answerLocally();
+        RequestRecord& logRequest(PageRequest const& request);
+        void finish(RollOutcome outcome);
+
+        PageFetcher& m_fetcher;
+        Timer& m_timer;
+        RequestScheduler* m_scheduler = nullptr;
+        RollEngine* m_engine = nullptr;
+        Completion m_completion;
+        RollStats m_stats;
+        std::deque<PageRequest> m_queue;
+        bool m_waiting = false;
+        int m_inFlight = 0;
+        double m_pacedBeforeNext = 0.0;
+        uint64_t m_generation = 0;
+    };
+}
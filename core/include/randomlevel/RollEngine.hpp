@@ -0,0 +1,110 @@
+#pragma once
+
+#include "PageFetcher.hpp"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace randomlevel {
+    // Whether a roll started from a cached answer (a filter's max page, the
+    // newest level ID) or had to find it first.
+    enum class CacheUse { None, Hit, Miss };
+
+    struct LevelSlot {
+        int page = 0;
+        int slot = 0;
+
+        bool operator==(LevelSlot const&) const = default;
+    };
+
+    struct RollStep {
+        enum class Kind { Fetch, Wait, Done, Abort };
+
+        Kind kind = Kind::Abort;
+        std::vector<PageRequest> requests;
+        float delay = 0.0f;
+        int page = 0;
+        int slot = 0;
+        std::vector<LevelSlot> picks;
+        std::string reason;
+
+        static RollStep fetch(PageRequest request, float delay) {
+            RollStep step;
+            step.kind = Kind::Fetch;
+            step.requests.push_back(std::move(request));
+            step.delay = delay;
+            return step;
+        }
+
+        static RollStep fetchAll(std::vector<PageRequest> requests, float delay) {
+            RollStep step;
+            step.kind = Kind::Fetch;
+            step.requests = std::move(requests);
+            step.delay = delay;
+            return step;
+        }
+
+        static RollStep wait() {
+            RollStep step;
+            step.kind = Kind::Wait;
+            return step;
+        }
+
+        static RollStep done(int page, int slot) {
+            RollStep step;
+            step.kind = Kind::Done;
+            step.page = page;
+            step.slot = slot;
+            step.picks.push_back({ page, slot });
+            return step;
+        }
+
+        // Several levels in the order they should be played; page and slot
+        // name the first one.
+        static RollStep doneAll(std::vector<LevelSlot> picks) {
+            if (picks.empty()) return abort("No levels picked.");
+            auto step = done(picks.front().page, picks.front().slot);
+            step.picks = std::move(picks);
+            return step;
+        }
+
+        static RollStep abort(std::string reason) {
+            RollStep step;
+            step.kind = Kind::Abort;
+            step.reason = std::move(reason);
+            return step;
+        }
+    };
+
+    // A roll is a state machine: it is started once, then fed the result of
+    // every request it asked for until it returns Done or Abort. Done refers
+    // to a slot in the most recent result received for that page. A Fetch
+    // with several requests puts them all in flight at once; their results
+    // arrive one by one, in any order, and the engine answers Wait until it
+    // has what it needs.
+    class RollEngine {
+    public:
+        using NoteSink = std::function<void(std::string const&)>;
+
+        virtual ~RollEngine() = default;
+        virtual RollStep start() = 0;
+        virtual RollStep onResult(PageResult const& result) = 0;
+        virtual std::string_view phaseName() const = 0;
+
+        // For telemetry, read once the roll is over.
+        virtual CacheUse cacheUse() const { return CacheUse::None; }
+        virtual int invalidations() const { return 0; }
+
+        void setNoteSink(NoteSink sink) { m_noteSink = std::move(sink); }
+
+    protected:
+        void note(std::string const& message) const {
+            if (m_noteSink) m_noteSink(message);
+        }
+
+    private:
+        NoteSink m_noteSink;
+    };
+}
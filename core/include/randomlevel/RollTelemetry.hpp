@@ -0,0 +1,67 @@
+#pragma once
+
+#include "RollDriver.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+
+namespace randomlevel {
+    // One finished roll. mode is a display name ("Smart", "Chaos", ...) and
+    // filterHash is 0 for rolls without filters.
+    struct RollRecord {
+        std::string mode;
+        uint64_t filterHash = 0;
+        bool success = false;
+        RollStats stats;
+    };
+
+    // latency sums send-to-answer time of the phase's requests and paced the
+    // pacing delays spent before them.
+    struct PhaseCounters {
+        long long requests = 0;
+        long long failures = 0;
+        double latency = 0.0;
+        double paced = 0.0;
+    };
+
+    struct TelemetryCounters {
+        long long rolls = 0;
+        long long successes = 0;
+        long long requests = 0;
+        long long localHits = 0;
+        long long failures = 0;
+        long long cacheHits = 0;
+        long long cacheMisses = 0;
+        long long invalidations = 0;
+        double rollTime = 0.0;
+        double pacingTime = 0.0;
+        std::map<std::string, long long> rollsByMode;
+        std::map<std::string, PhaseCounters> phases;
+
+        void add(RollRecord const& record);
+    };
+
+    // Totals over every roll recorded, which the owner persists, plus the
+    // last few rolls in full for a Chrome trace-event export (load the JSON
+    // in chrome://tracing or Perfetto). Each roll is one span with its
+    // pacing waits nested inside; requests go on parallel tracks.
+    class RollTelemetry {
+    public:
+        explicit RollTelemetry(size_t keepRolls = 50) : m_keepRolls(keepRolls) {}
+
+        void record(RollRecord record);
+
+        TelemetryCounters& counters() { return m_counters; }
+        TelemetryCounters const& counters() const { return m_counters; }
+        std::deque<RollRecord> const& recent() const { return m_recent; }
+
+        std::string chromeTrace() const;
+
+    private:
+        size_t m_keepRolls;
+        TelemetryCounters m_counters;
+        std::deque<RollRecord> m_recent;
+    };
+}
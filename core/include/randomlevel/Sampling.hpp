@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Random.hpp"
+
+#include <vector>
+
+namespace randomlevel {
+    // Floyd's algorithm: `count` distinct values from [min, max], each subset
+    // equally likely. Returns fewer values when the range is smaller than count.
+    std::vector<int> sampleDistinct(Rng& rng, int min, int max, int count);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace randomlevel {
+    // Level IDs the player has already been shown, so rolls can pick around
+    // them. The newest IDs are kept exactly in a small ring; all of them go
+    // into a Bloom filter sized for `capacity` IDs at about 1% false
+    // positives. Once a filter holds `capacity` IDs it becomes the older of
+    // two generations and a fresh one starts, so memory stays fixed and at
+    // least the last `capacity` levels are remembered. A false positive only
+    // hides an unseen level from one roll. Capacity 0 remembers nothing.
+    class SeenLevels {
+    public:
+        static constexpr size_t recentCapacity = 256;
+
+        explicit SeenLevels(size_t capacity = 20000);
+
+        void insert(int levelID, double now);
+        bool contains(int levelID) const;
+        void clear();
+
+        size_t capacity() const { return m_capacity; }
+        // Starts over from the recent ring when the capacity changes.
+        void setCapacity(size_t capacity);
+        size_t memoryBytes() const;
+
+        bool needsFlush(double now, double flushDelay, int flushBatch) const;
+        int pendingChanges() const { return m_pendingChanges; }
+
+        std::vector<uint8_t> serialize();
+        bool deserialize(std::span<uint8_t const> data);
+
+    private:
+        struct Generation {
+            std::vector<uint64_t> bits;
+            uint32_t count = 0;
+
+            bool contains(uint64_t hash) const;
+            void insert(uint64_t hash);
+        };
+
+        void reset();
+        void add(int levelID);
+
+        size_t m_capacity;
+        Generation m_current;
+        Generation m_previous;
+        std::vector<int> m_recent;
+        size_t m_recentNext = 0;
+        int m_pendingChanges = 0;
+        double m_firstPendingAt = 0.0;
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "PageFetcher.hpp"
+#include "Random.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace randomlevel {
+    // Virtual-time event loop. Callbacks scheduled through the Timer
+    // interface can be cancelled; server responses posted with post() cannot.
+    class SimClock : public Timer {
+    public:
+        double now() const override { return m_now; }
+        void after(double seconds, std::function<void()> callback) override;
+        void cancel() override { m_timerGeneration++; }
+
+        void post(double seconds, std::function<void()> callback);
+        bool step();
+        void run();
+
+    private:
+        struct Event {
+            double time;
+            uint64_t sequence;
+            std::function<void()> callback;
+
+            bool operator>(Event const& other) const {
+                return time != other.time ? time > other.time : sequence > other.sequence;
+            }
+        };
+
+        std::priority_queue<Event, std::vector<Event>, std::greater<>> m_events;
+        double m_now = 0.0;
+        uint64_t m_sequence = 0;
+        uint64_t m_timerGeneration = 0;
+    };
+
+    struct SimServerConfig {
+        int totalLevels = 0;
+        bool reportsTotal = true;
+        bool page1000Glitch = true;
+        bool emptyAsFailure = false;
+        double failureRate = 0.0;
+        double latency = 0.25;
+        double latencyJitter = 0.05;
+        int maxLevelID = 110000000;
+        double liveIDDensity = 0.6;
+        int rateLimit = 0;
+        double rateWindow = 60.0;
+        double banDuration = 0.0;
+        int storedPages = 0;
+        uint64_t seed = 1;
+    };
+
+    // In-process stand-in for getGJLevels. A filter's result set is levels
+    // [0, totalLevels); sets bigger than 1000 full pages repeat forever when
+    // page1000Glitch is on. Level IDs are live with probability liveIDDensity.
+    // More than rateLimit requests inside rateWindow seconds bans the client
+    // for banDuration seconds, during which every request fails.
+    // emptyAsFailure reports empty answers as FailedOrEmpty, the way
+    // GameLevelFetcher surfaces the server's "-1"; only a lookup of a single
+    // ID is a clean empty answer there. Filter pages below storedPages are
+    // already on the device, as if the player had browsed them, and lookup()
+    // answers them without a request.
+    class SimulatedServer : public PageFetcher {
+    public:
+        static constexpr int reportedTotalCap = 9999;
+
+        SimulatedServer(SimClock& clock, SimServerConfig config);
+
+        void fetch(PageRequest const& request, Callback callback) override;
+        void cancel() override { m_generation++; }
+        std::optional<PageResult> lookup(PageRequest const& request) override;
+
+        SimServerConfig& config() { return m_config; }
+        int requestCount() const { return m_requestCount; }
+        int banCount() const { return m_banCount; }
+        bool isLive(int levelID) const;
+        int levelIDAt(int globalIndex) const { return 1000 + globalIndex; }
+
+    private:
+        PageResult respond(PageRequest const& request);
+        bool throttled();
+
+        SimClock& m_clock;
+        SimServerConfig m_config;
+        Rng m_rng;
+        int m_requestCount = 0;
+        int m_banCount = 0;
+        double m_bannedUntil = 0.0;
+        std::deque<double> m_recentRequests;
+        uint64_t m_generation = 0;
+    };
+}
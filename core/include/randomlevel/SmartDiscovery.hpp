@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DiscoveryEngine.hpp"
+
+namespace randomlevel {
+    // The original page discovery: trust the reported total when it is small,
+    // otherwise bisect between page 0 and page 1000 and re-fetch the last page
+    // for its exact count. Page 1000 answering with levels means the server is
+    // repeating results, in which case the set is capped at 501 pages. A
+    // cached page that turns out stale is corrected by bisecting a short
+    // bracket next to it, or by starting over when the end lies outside it.
+    class SmartDiscovery : public DiscoveryEngine {
+    public:
+        enum class SmartPhase {
+            Idle,
+            Phase1_CheckTotal,
+            Phase2_CachePeek,
+            Phase2b_CacheNext,
+            Phase2c_CacheBracket,
+            Phase3_GlitchCheck,
+            Phase4_BinarySearch,
+            Phase5_CalcExact
+        };
+
+        SmartDiscovery(Rng& rng, DiscoveryHints hints);
+
+        SmartPhase phase() const { return m_smartPhase; }
+
+    protected:
+        RollStep startDiscovery() override;
+        RollStep onDiscoveryResult(PageResult const& result) override;
+        std::string_view discoveryPhaseName() const override;
+
+    private:
+        RollStep onPage(PageResult const& result);
+        RollStep onFailed(PageResult const& result);
+        RollStep beginBinarySearch(int low, int high);
+        RollStep advanceBinarySearch();
+        RollStep bracketCache(int page);
+        RollStep onBracketPage(int count);
+        RollStep request(float delay);
+
+        SmartPhase m_smartPhase = SmartPhase::Idle;
+        int m_searchLow = 0;
+        int m_searchHigh = 0;
+        int m_foundMaxPage = 0;
+        int m_bracketPage = 0;
+    };
+}
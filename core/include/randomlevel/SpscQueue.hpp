@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace randomlevel {
+    // Bounded ring buffer for exactly one producer thread and one consumer
+    // thread. Neither side locks; each index is only written by its owner and
+    // published with release ordering. Capacity is rounded up to a power of
+    // two.
+    template <class T>
+    class SpscQueue {
+    public:
+        explicit SpscQueue(size_t capacity)
+            : m_slots(std::bit_ceil(capacity < 2 ? size_t(2) : capacity)), m_mask(m_slots.size() - 1) {}
+
+        SpscQueue(SpscQueue const&) = delete;
+        SpscQueue& operator=(SpscQueue const&) = delete;
+
+        // Producer side. False when the queue is full; the value is untouched.
+        bool tryPush(T& value) {
+            auto tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) return false;
+            m_slots[tail & m_mask] = std::move(value);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side.
+        std::optional<T> tryPop() {
+            auto head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) return std::nullopt;
+            std::optional<T> value(std::move(m_slots[head & m_mask]));
+            m_slots[head & m_mask] = T();
+            m_head.store(head + 1, std::memory_order_release);
+            return value;
+        }
+
+        // Exact only on the consumer side; a hint anywhere else.
+        bool empty() const {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+        size_t capacity() const { return m_slots.size(); }
+
+    private:
+        std::vector<T> m_slots;
+        size_t m_mask;
+        alignas(64) std::atomic<size_t> m_head = 0;
+        alignas(64) std::atomic<size_t> m_tail = 0;
+    };
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace randomlevel {
+    // Background threads for work that must not stall the frame. A job runs
+    // on a worker and returns a completion, which runs on the thread that
+    // owns the pool the next time it calls drain(). Jobs given the same lane
+    // run in submission order on one worker, so writes to one file never
+    // overtake each other. Jobs and completions travel through one pair of
+    // single-producer queues per worker, so every method must be called from
+    // the owning thread.
+    class WorkerPool {
+    public:
+        using Completion = std::function<void()>;
+        using Job = std::function<Completion()>;
+
+        explicit WorkerPool(int threads, size_t queueCapacity = 256);
+        // Finishes the jobs already queued, then joins; their completions
+        // are dropped.
+        ~WorkerPool();
+
+        WorkerPool(WorkerPool const&) = delete;
+        WorkerPool& operator=(WorkerPool const&) = delete;
+
+        // Lane -1 picks workers round-robin. When the worker's queue is full
+        // this waits for room, running completions meanwhile.
+        void submit(Job job, int lane = -1);
+        // Runs the completions that are ready and returns how many ran.
+        int drain();
+        // Blocks until every submitted job has completed, running
+        // completions as they arrive.
+        void waitIdle();
+
+        int pending() const { return m_pending; }
+        int threadCount() const { return static_cast<int>(m_workers.size()); }
+
+    private:
+        struct Worker {
+            explicit Worker(size_t capacity) : jobs(capacity), completions(capacity) {}
+
+            SpscQueue<Job> jobs;
+            SpscQueue<Completion> completions;
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::thread thread;
+        };
+
+        void work(Worker& worker);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<bool> m_stopping = false;
+        size_t m_nextWorker = 0;
+        int m_pending = 0;
+    };
+}
@@ -0,0 +1,163 @@
+#include <randomlevel/ByteScan.hpp>
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RANDOMLEVEL_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RANDOMLEVEL_SCAN_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define RANDOMLEVEL_SCAN_NEON
+#endif
+
+using namespace randomlevel;
+
+namespace {
+    // Each backend scans whole blocks and returns a bitmask with bit i set
+    // when byte i of the block matches. NEON has no movemask, so its mask
+    // uses four bits per byte.
+#if defined(RANDOMLEVEL_SCAN_AVX2)
+    constexpr size_t blockSize = 32;
+    constexpr int bitsPerByte = 1;
+
+    uint64_t matchMask(char const* block, char byte) {
+        auto data = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block));
+        auto hits = _mm256_cmpeq_epi8(data, _mm256_set1_epi8(byte));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+    }
+
+    // Matches are summed per byte lane (a match is -1, so subtracting adds
+    // one) and folded into the total before a lane can overflow.
+    size_t countBlocks(char const* data, size_t blocks, char byte) {
+        auto needle = _mm256_set1_epi8(byte);
+        size_t count = 0;
+        while (blocks) {
+            auto batch = blocks < 255 ? blocks : 255;
+            blocks -= batch;
+            auto lanes = _mm256_setzero_si256();
+            for (; batch; batch--, data += blockSize) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data));
+                lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(block, needle));
+            }
+            auto sums = _mm256_sad_epu8(lanes, _mm256_setzero_si256());
+            count += _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1)
+                + _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+        }
+        return count;
+    }
+#elif defined(RANDOMLEVEL_SCAN_SSE2)
+    constexpr size_t blockSize = 16;
+    constexpr int bitsPerByte = 1;
+
+    uint64_t matchMask(char const* block, char byte) {
+        auto data = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block));
+        auto hits = _mm_cmpeq_epi8(data, _mm_set1_epi8(byte));
+        return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+    }
+
+    // Matches are summed per byte lane (a match is -1, so subtracting adds
+    // one) and folded into the total before a lane can overflow.
+    size_t countBlocks(char const* data, size_t blocks, char byte) {
+        auto needle = _mm_set1_epi8(byte);
+        size_t count = 0;
+        while (blocks) {
+            auto batch = blocks < 255 ? blocks : 255;
+            blocks -= batch;
+            auto lanes = _mm_setzero_si128();
+            for (; batch; batch--, data += blockSize) {
+                auto block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data));
+                lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(block, needle));
+            }
+            auto sums = _mm_sad_epu8(lanes, _mm_setzero_si128());
+            count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+        }
+        return count;
+    }
+#elif defined(RANDOMLEVEL_SCAN_NEON)
+    constexpr size_t blockSize = 16;
+    constexpr int bitsPerByte = 4;
+
+    uint64_t matchMask(char const* block, char byte) {
+        auto data = vld1q_u8(reinterpret_cast<uint8_t const*>(block));
+        auto hits = vceqq_u8(data, vdupq_n_u8(static_cast<uint8_t>(byte)));
+        auto nibbles = vshrn_n_u16(vreinterpretq_u16_u8(hits), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull;
+    }
+
+    size_t countBlocks(char const* data, size_t blocks, char byte) {
+        auto needle = vdupq_n_u8(static_cast<uint8_t>(byte));
+        size_t count = 0;
+        while (blocks) {
+            auto batch = blocks < 255 ? blocks : 255;
+            blocks -= batch;
+            auto lanes = vdupq_n_u8(0);
+            for (; batch; batch--, data += blockSize) {
+                auto hits = vceqq_u8(vld1q_u8(reinterpret_cast<uint8_t const*>(data)), needle);
+                lanes = vsubq_u8(lanes, hits);
+            }
+            // Pairwise widening adds instead of vaddlvq_u8, which only
+            // AArch64 has; armv7 builds take this path too.
+            auto sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(lanes)));
+            count += vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1);
+        }
+        return count;
+    }
+#endif
+}
+
+size_t randomlevel::findByteScalar(std::string_view text, char byte, size_t from) {
+    for (size_t i = from; i < text.size(); i++) {
+        if (text[i] == byte) return i;
+    }
+    return std::string_view::npos;
+}
+
+size_t randomlevel::countByteScalar(std::string_view text, char byte) {
+    size_t count = 0;
+    for (char c : text) count += c == byte;
+    return count;
+}
+
+#if defined(RANDOMLEVEL_SCAN_AVX2) || defined(RANDOMLEVEL_SCAN_SSE2) || defined(RANDOMLEVEL_SCAN_NEON)
+
+size_t randomlevel::findByte(std::string_view text, char byte, size_t from) {
+    auto data = text.data();
+    size_t i = from;
+    for (; i + blockSize <= text.size(); i += blockSize) {
+        if (auto mask = matchMask(data + i, byte)) return i + std::countr_zero(mask) / bitsPerByte;
+    }
+    return findByteScalar(text, byte, i);
+}
+
+size_t randomlevel::countByte(std::string_view text, char byte) {
+    auto blocks = text.size() / blockSize;
+    return countBlocks(text.data(), blocks, byte) + countByteScalar(text.substr(blocks * blockSize), byte);
+}
+
+#else
+
+size_t randomlevel::findByte(std::string_view text, char byte, size_t from) {
+    return findByteScalar(text, byte, from);
+}
+
+size_t randomlevel::countByte(std::string_view text, char byte) {
+    return countByteScalar(text, byte);
+}
+
+#endif
+
+char const* randomlevel::byteScanBackend() {
+#if defined(RANDOMLEVEL_SCAN_AVX2)
+    return "AVX2";
+#elif defined(RANDOMLEVEL_SCAN_SSE2)
+    return "SSE2";
+#elif defined(RANDOMLEVEL_SCAN_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
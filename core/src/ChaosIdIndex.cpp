@@ -0,0 +1,83 @@
+#include <randomlevel/Binary.hpp>
+#include <randomlevel/ChaosIdIndex.hpp>
+#include <randomlevel/Sampling.hpp>
+
+#include <algorithm>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr uint32_t indexMagic = 0x42494c52; // "RLIB"
+    constexpr uint16_t indexVersion = 1;
+}
+
+void ChaosIdIndex::record(std::span<int const> probed, std::span<int const> found, int newestID, double now) {
+    int changes = 0;
+    for (int id : probed) {
+        if (id < 0) continue;
+        bool live = std::find(found.begin(), found.end(), id) != found.end();
+        if (!live && id > newestID) continue;
+        // A level that was live can be deleted later, so an ID moves between sets.
+        auto& add = live ? m_live : m_dead;
+        auto& drop = live ? m_dead : m_live;
+        if (add.add((uint32_t)id)) changes++;
+        drop.remove((uint32_t)id);
+    }
+    if (changes == 0) return;
+
+    if (m_pendingChanges == 0) m_firstPendingAt = now;
+    m_pendingChanges += changes;
+}
+
+void ChaosIdIndex::clear() {
+    m_dead.clear();
+    m_live.clear();
+    m_pendingChanges = 0;
+}
+
+std::vector<int> ChaosIdIndex::sample(Rng& rng, int min, int max, int count) const {
+    if (max < min || count <= 0) return {};
+
+    min = std::max(min, 0);
+    uint64_t deadInRange = m_dead.rank((uint32_t)max) - (min > 0 ? m_dead.rank((uint32_t)min - 1) : 0);
+    int64_t remaining = (int64_t)max - min + 1 - (int64_t)deadInRange;
+    if (remaining <= 0) return {};
+
+    // Draw positions among the IDs that are not known dead, then map each
+    // position back to its ID. Every such ID is equally likely.
+    auto picks = sampleDistinct(rng, 0, (int)(remaining - 1), count);
+    for (auto& pick : picks) pick = (int)m_dead.selectAbsent((uint32_t)min, (uint32_t)max, (uint64_t)pick);
+    return picks;
+}
+
+bool ChaosIdIndex::needsFlush(double now, double flushDelay, int flushBatch) const {
+    if (m_pendingChanges == 0) return false;
+    return m_pendingChanges >= flushBatch || now - m_firstPendingAt >= flushDelay;
+}
+
+std::vector<uint8_t> ChaosIdIndex::serialize() {
+    ByteWriter out;
+    out.put(indexMagic);
+    out.put(indexVersion);
+    m_dead.write(out);
+    m_live.write(out);
+
+    m_pendingChanges = 0;
+    return out.take();
+}
+
+bool ChaosIdIndex::deserialize(std::span<uint8_t const> data) {
+    ByteReader in(data);
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    if (!in.get(magic) || magic != indexMagic || !in.get(version) || version != indexVersion) {
+        return false;
+    }
+
+    m_pendingChanges = 0;
+    if (!m_dead.read(in) || !m_live.read(in)) {
+        this->clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#include <randomlevel/ChaosRoll.hpp>
+#include <randomlevel/Sampling.hpp>
+
+#include <algorithm>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr float probeDelay = 0.5f;
+}
+
+ChaosRoll::ChaosRoll(Rng& rng, int knownMaxID, int batchSize)
+    : m_rng(rng), m_maxOnlineID(knownMaxID), m_batchSize(std::clamp(batchSize, 1, maxBatchSize)) {
+    if (knownMaxID > 0) m_cacheUse = CacheUse::Hit;
+}
+
+RollTask ChaosRoll::run() {
+    float delay = 0.0f;
+
+    if (m_maxOnlineID == 0) {
+        this->setPhase("Chaos_FetchLatest");
+        PageRequest latest;
+        latest.kind = RequestKind::Recent;
+        auto result = co_await this->fetch(latest, 0.0f);
+        while (!result.ok()) result = co_await this->fetch(latest, probeDelay);
+
+        if (result.count() > 0 && result.levelIDs.front() > 0) {
+            m_maxOnlineID = result.levelIDs.front();
+            if (m_hooks.maxIDFound) m_hooks.maxIDFound(m_maxOnlineID);
+        }
+        if (m_maxOnlineID == 0) m_maxOnlineID = fallbackMaxID;
+        delay = probeDelay;
+    }
+
+    this->setPhase("Chaos_Probe");
+    while (true) {
+        auto result = co_await this->fetch(this->nextProbe(), delay);
+        delay = probeDelay;
+
+        if (this->isComplete(result) && m_hooks.probeAnswered) m_hooks.probeAnswered(m_probedIDs, result);
+        if (!result.ok() || result.count() == 0) continue;
+        if (!m_seen) co_return RollStep::done(result.page, m_rng.uniformInt(0, result.count() - 1));
+
+        std::vector<int> unseen;
+        for (int slot = 0; slot < result.count(); slot++) {
+            if (!m_seen->contains(result.levelIDs[slot])) unseen.push_back(slot);
+        }
+        if (!unseen.empty()) {
+            co_return RollStep::done(result.page, unseen[m_rng.uniformInt(0, (int)unseen.size() - 1)]);
+        }
+    }
+}
+
+// FailedOrEmpty may be a network error, and a full page of levels may have
+// been cut short by the server, so neither says which IDs are missing.
+bool ChaosRoll::isComplete(PageResult const& result) const {
+    if (!result.ok()) return false;
+    return result.count() < maxBatchSize || result.count() >= (int)m_probedIDs.size();
+}
+
+PageRequest ChaosRoll::nextProbe() {
+    int max = (m_maxOnlineID > 0) ? m_maxOnlineID : fallbackMaxID;
+
+    PageRequest req;
+    req.kind = RequestKind::IdLookup;
+    if (m_index) req.ids = m_index->sample(m_rng, minLevelID, max, m_batchSize);
+    // Every ID in range being known dead means the index is stale, so ignore it.
+    if (req.ids.empty()) req.ids = sampleDistinct(m_rng, minLevelID, max, m_batchSize);
+    // A batch of nothing but seen IDs is sent as is rather than drawn forever.
+    if (m_seen && !std::all_of(req.ids.begin(), req.ids.end(), [&](int id) { return m_seen->contains(id); })) {
+        std::erase_if(req.ids, [&](int id) { return m_seen->contains(id); });
+    }
+    m_probedIDs = req.ids;
+    return req;
+}
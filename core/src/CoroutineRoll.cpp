@@ -0,0 +1,62 @@
+#include <randomlevel/CoroutineRoll.hpp>
+
+#include <exception>
+
+using namespace randomlevel;
+
+// Rolls never throw on purpose; an escaping exception is a bug.
+void RollTask::promise_type::unhandled_exception() noexcept {
+    std::terminate();
+}
+
+RollTask& RollTask::operator=(RollTask&& other) noexcept {
+    if (this != &other) {
+        if (m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+}
+
+RollTask::~RollTask() {
+    if (m_handle) m_handle.destroy();
+}
+
+RollStep CoroutineRoll::start() {
+    m_step.reset();
+    m_awaited.reset();
+    m_result.reset();
+    m_phase = "Idle";
+
+    m_task = this->run();
+    m_task.resume();
+    return this->takeStep();
+}
+
+RollStep CoroutineRoll::onResult(PageResult const& result) {
+    if (!m_awaited) return RollStep::wait();
+    // A filter page answers only the page that was asked for.
+    if (m_awaited->kind == RequestKind::FilterPage && m_awaited->page != result.page) return RollStep::wait();
+
+    m_awaited.reset();
+    m_result = result;
+    m_task.resume();
+    return this->takeStep();
+}
+
+void CoroutineRoll::await(PageRequest request, float delay) {
+    m_awaited = request;
+    m_result.reset();
+    m_step = RollStep::fetch(std::move(request), delay);
+}
+
+RollStep CoroutineRoll::takeStep() {
+    if (m_task.done()) {
+        auto& result = m_task.result();
+        if (!result) return RollStep::abort("Roll ended without a result.");
+        return std::move(*result);
+    }
+    if (!m_step) return RollStep::abort("Roll suspended without a request.");
+    auto step = std::move(*m_step);
+    m_step.reset();
+    return step;
+}
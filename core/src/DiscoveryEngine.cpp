@@ -0,0 +1,271 @@
+#include <randomlevel/DiscoveryEngine.hpp>
+#include <randomlevel/GallopDiscovery.hpp>
+#include <randomlevel/ParallelDiscovery.hpp>
+#include <randomlevel/Sampling.hpp>
+#include <randomlevel/SmartDiscovery.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+using namespace randomlevel;
+
+DiscoveryEngine::DiscoveryEngine(Rng& rng, DiscoveryHints hints)
+    : m_rng(rng), m_hints(std::move(hints)) {
+    if (m_hints.cachedMaxPage) m_cacheUse = CacheUse::Hit;
+    m_hints.lowerPage = std::max(m_hints.lowerPage, 0);
+    if (auto& checkpoint = m_hints.checkpoint) {
+        if (checkpoint->firstEmpty && *checkpoint->firstEmpty <= checkpoint->lastFull) checkpoint.reset();
+        else m_progress = *checkpoint;
+    }
+    if (this->hintedFirstEmpty(INT_MAX) <= this->hintedLowPage()) {
+        m_hints.lowerPage = 0;
+        m_hints.upperPage.reset();
+    }
+    if (this->hintedFirstEmpty(INT_MAX) <= this->hintedLastFull()) {
+        m_hints.checkpoint.reset();
+        m_progress = {};
+    }
+}
+
+RollStep DiscoveryEngine::start() {
+    m_retryCount = 0;
+    m_fetchingTarget = false;
+    m_pageLevels.clear();
+    m_failedPages.clear();
+    return this->startDiscovery();
+}
+
+RollStep DiscoveryEngine::onResult(PageResult const& result) {
+    if (result.ok()) m_pageLevels[result.page] = result.levelIDs;
+    if (m_fetchingTarget) return this->onTargetResult(result);
+    this->recordProgress(result);
+    return this->onDiscoveryResult(result);
+}
+
+// Page 0 coming back as FailedOrEmpty is retried by every strategy, so only
+// later pages are taken as empty from it, the way the searches take them.
+void DiscoveryEngine::recordProgress(PageResult const& result) {
+    int count = result.count();
+    bool full = result.ok() && count == 10 && result.page < 1000;
+    bool empty = (result.ok() && count == 0) || (result.maybeEmpty() && result.page > 0);
+
+    auto progress = m_progress;
+    if (full) {
+        progress.lastFull = std::max(progress.lastFull, result.page);
+        if (progress.firstEmpty && *progress.firstEmpty <= progress.lastFull) progress.firstEmpty.reset();
+    }
+    else if (empty && result.page > progress.lastFull) {
+        progress.firstEmpty = std::min(progress.firstEmpty.value_or(result.page), result.page);
+    }
+
+    if (progress == m_progress) return;
+    m_progress = progress;
+    if (m_hooks.checkpointed) m_hooks.checkpointed(m_progress);
+}
+
+std::string_view DiscoveryEngine::phaseName() const {
+    return m_fetchingTarget ? "Phase6_FetchTarget" : this->discoveryPhaseName();
+}
+
+PageRequest DiscoveryEngine::pageRequest(int page) {
+    PageRequest req;
+    req.kind = RequestKind::FilterPage;
+    req.page = page;
+    return req;
+}
+
+RollStep DiscoveryEngine::fetchPage(int page, float delay) {
+    return RollStep::fetch(pageRequest(page), delay);
+}
+
+int DiscoveryEngine::hintedLastFull() const {
+    int lastFull = m_hints.lowerPage - 1;
+    if (m_hints.checkpoint) lastFull = std::max(lastFull, m_hints.checkpoint->lastFull);
+    return lastFull;
+}
+
+int DiscoveryEngine::hintedFirstEmpty(int fallback) const {
+    if (m_hints.upperPage) fallback = std::min(fallback, *m_hints.upperPage + 1);
+    if (m_hints.checkpoint && m_hints.checkpoint->firstEmpty) fallback = std::min(fallback, *m_hints.checkpoint->firstEmpty);
+    return fallback;
+}
+
+bool DiscoveryEngine::failedBefore(int page) {
+    if (m_failedPages.insert(page).second) return false;
+    m_failedPages.erase(page);
+    m_retryCount = 0;
+    return true;
+}
+
+RollStep DiscoveryEngine::retryOrAbort(RollStep retry) {
+    m_retryCount++;
+    if (m_retryCount > maxRetries) return RollStep::abort("Connection Failed or Timed Out.");
+    return retry;
+}
+
+RollStep DiscoveryEngine::prepareTarget(int maxPageInclusive, int levelsOnMaxPage) {
+    long long totalLevels = ((long long)maxPageInclusive * 10) + levelsOnMaxPage;
+
+    if (m_hooks.maxPageFound) m_hooks.maxPageFound(maxPageInclusive);
+
+    // Floyd's draw is not in random order, so shuffle it into a play order.
+    auto indices = sampleDistinct(m_rng, 0, (int)totalLevels - 1, m_pickCount);
+    std::shuffle(indices.begin(), indices.end(), m_rng.engine());
+
+    m_targets.clear();
+    m_pendingPages.clear();
+    m_targetsStale = false;
+    m_totalLevels = totalLevels;
+    m_redraws = 0;
+    for (int index : indices) {
+        m_targets.push_back({ index / 10, index % 10 });
+        if (!m_pageLevels.contains(index / 10)) m_pendingPages.insert(index / 10);
+    }
+    m_fetchingTarget = true;
+
+    if (m_pendingPages.empty()) {
+        note("Phase 6: Target Page " + std::to_string(m_targets.front().page) + " already fetched.");
+        return this->resolveTargets();
+    }
+
+    std::vector<PageRequest> requests;
+    for (int page : m_pendingPages) requests.push_back(pageRequest(page));
+    if (requests.size() == 1) note("Phase 6: Fetching Target Page " + std::to_string(requests.front().page));
+    else note("Phase 6: Fetching " + std::to_string(requests.size()) + " Target Pages");
+    return RollStep::fetchAll(std::move(requests), targetDelay);
+}
+
+// Results of a batch keep arriving after one of them shows the count is
+// stale, so the restart waits until every outstanding target page is in.
+RollStep DiscoveryEngine::onTargetResult(PageResult const& result) {
+    int page = result.page;
+    if (!m_pendingPages.contains(page)) return RollStep::wait();
+
+    if (result.ok() && result.count() > 0) {
+        m_pendingPages.erase(page);
+    }
+    else if (result.ok() || (result.maybeEmpty() && this->failedBefore(page)) || m_targetsStale) {
+        m_targetsStale = true;
+        m_pendingPages.erase(page);
+    }
+    else {
+        return this->retryOrAbort(fetchPage(page, retryDelay));
+    }
+
+    if (!m_pendingPages.empty()) return RollStep::wait();
+    if (m_targetsStale) return this->restartDiscovery();
+    return this->resolveTargets();
+}
+
+// A redraw that lands on a page not fetched yet waits for it; the targets
+// are resolved again, in order, once every such page is in.
+RollStep DiscoveryEngine::resolveTargets() {
+    std::vector<LevelSlot> picks;
+    for (auto& target : m_targets) {
+        while (true) {
+            auto it = m_pageLevels.find(target.page);
+            if (it == m_pageLevels.end()) break;
+            int count = static_cast<int>(it->second.size());
+            if (count == 0) return this->restartDiscovery();
+
+            // A page that shrank since discovery moves the pick to its last level.
+            target.slot = std::min(target.slot, count - 1);
+            if (auto slot = this->unseenSlot(it->second, target, picks)) {
+                target.slot = *slot;
+                break;
+            }
+            if (m_redraws >= maxRedraws) {
+                // Out of redraws, the closest level on a page already fetched
+                // stands in, unseen if any is left.
+                if (auto closest = this->closestSlot(target, picks, true)) target = *closest;
+                else if (auto fallback = this->closestSlot(target, picks, false)) target = *fallback;
+                break;
+            }
+
+            m_redraws++;
+            int index = m_rng.uniformInt(0, static_cast<int>(m_totalLevels) - 1);
+            note("Phase 6: Page " + std::to_string(target.page) + " has nothing unseen. Redrawing.");
+            target = { index / 10, index % 10 };
+        }
+
+        if (!m_pageLevels.contains(target.page)) m_pendingPages.insert(target.page);
+        else if (std::find(picks.begin(), picks.end(), target) == picks.end()) picks.push_back(target);
+    }
+
+    if (!m_pendingPages.empty()) {
+        std::vector<PageRequest> requests;
+        for (int page : m_pendingPages) requests.push_back(pageRequest(page));
+        return RollStep::fetchAll(std::move(requests), targetDelay);
+    }
+    if (picks.size() < m_targets.size()) {
+        note("Phase 6: Only " + std::to_string(picks.size()) + " of " + std::to_string(m_targets.size()) +
+            " levels could be picked.");
+    }
+    return RollStep::doneAll(std::move(picks));
+}
+
+// The level nearest the target in result order, among the pages fetched this
+// roll, that is not picked yet and, with unseenOnly, not seen either.
+std::optional<LevelSlot> DiscoveryEngine::closestSlot(LevelSlot target, std::vector<LevelSlot> const& picks, bool unseenOnly) const {
+    long long origin = (long long)target.page * 10 + target.slot;
+    std::optional<LevelSlot> closest;
+    long long closestDistance = 0;
+    for (auto const& [page, levelIDs] : m_pageLevels) {
+        for (int slot = 0; slot < static_cast<int>(levelIDs.size()); slot++) {
+            LevelSlot candidate { page, slot };
+            if (std::find(picks.begin(), picks.end(), candidate) != picks.end()) continue;
+            if (unseenOnly && m_seen && m_seen->contains(levelIDs[slot])) continue;
+
+            long long distance = std::abs((long long)page * 10 + slot - origin);
+            if (!closest || distance < closestDistance) {
+                closest = candidate;
+                closestDistance = distance;
+            }
+        }
+    }
+    return closest;
+}
+
+// The target's own slot when it is unseen and not picked yet, otherwise a
+// uniform draw among the page's slots that are neither. Without a seen set
+// the target's slot always stands.
+std::optional<int> DiscoveryEngine::unseenSlot(std::vector<int> const& levelIDs, LevelSlot target, std::vector<LevelSlot> const& picks) {
+    if (!m_seen) return target.slot;
+
+    auto usable = [&](int slot) {
+        bool picked = std::find(picks.begin(), picks.end(), LevelSlot{ target.page, slot }) != picks.end();
+        return !picked && !m_seen->contains(levelIDs[slot]);
+    };
+    if (usable(target.slot)) return target.slot;
+
+    std::vector<int> slots;
+    for (int slot = 0; slot < static_cast<int>(levelIDs.size()); slot++) {
+        if (usable(slot)) slots.push_back(slot);
+    }
+    if (slots.empty()) return std::nullopt;
+    return slots[m_rng.uniformInt(0, static_cast<int>(slots.size()) - 1)];
+}
+
+RollStep DiscoveryEngine::restartDiscovery() {
+    note("Fast Path failed (Empty Page). Invalidating cache.");
+    if (m_hooks.cacheInvalidated) m_hooks.cacheInvalidated();
+    m_invalidations++;
+    m_hints = {};
+    m_progress = {};
+    m_fetchingTarget = false;
+    m_pageLevels.clear();
+    m_failedPages.clear();
+    return this->startDiscovery();
+}
+
+std::unique_ptr<DiscoveryEngine> randomlevel::makeDiscovery(
+    DiscoveryStrategy strategy, Rng& rng, DiscoveryHints hints, int parallelWidth
+) {
+    switch (strategy) {
+    case DiscoveryStrategy::Bisect: return std::make_unique<SmartDiscovery>(rng, std::move(hints));
+    case DiscoveryStrategy::Parallel: return std::make_unique<ParallelDiscovery>(rng, std::move(hints), parallelWidth);
+    default: return std::make_unique<GallopDiscovery>(rng, std::move(hints));
+    }
+}
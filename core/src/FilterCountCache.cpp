@@ -0,0 +1,199 @@
+#include <randomlevel/Binary.hpp>
+#include <randomlevel/FilterCountCache.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr uint32_t cacheMagic = 0x43464c52; // "RLFC"
+    // Keys before version 4 had no original, two-player or coins flags, so
+    // one entry may stand for several filters; those files are dropped.
+    constexpr uint16_t cacheVersion = 4;
+    // Max page stored for result sets that repeat past page 1000.
+    constexpr int infinitePage = 501;
+
+    constexpr double secondsPerDay = 86400.0;
+    constexpr double minRateWeight = 1.0 * secondsPerDay;
+    constexpr double maxRateWeight = 7.0 * secondsPerDay;
+    constexpr double maxExtrapolation = 30.0 * secondsPerDay;
+}
+
+FilterCountEntry FilterCountEntry::observe(int page, double now) const {
+    FilterCountEntry next = *this;
+    next.maxPage = page;
+    next.updatedAt = now;
+
+    double elapsed = now - updatedAt;
+    if (maxPage == infinitePage || page == infinitePage || elapsed < 0.0) {
+        next.pagesPerDay = 0.0f;
+        next.observedSince = now;
+        return next;
+    }
+
+    double weight = std::clamp(updatedAt - observedSince, minRateWeight, maxRateWeight);
+    double rate = pagesPerDay / secondsPerDay;
+    rate = (rate * weight + (page - maxPage)) / (weight + elapsed);
+    next.pagesPerDay = static_cast<float>(rate * secondsPerDay);
+    return next;
+}
+
+int FilterCountEntry::predictedPage(double now) const {
+    if (maxPage == infinitePage) return maxPage;
+
+    double elapsed = std::clamp(now - updatedAt, 0.0, maxExtrapolation);
+    int page = std::max(0, static_cast<int>(std::lround(maxPage + pagesPerDay * elapsed / secondsPerDay)));
+    // The strategies read 501 as the infinite marker.
+    return page == infinitePage ? infinitePage - 1 : page;
+}
+
+FilterCountCache::FilterCountCache(size_t capacity) : m_capacity(capacity ? capacity : 1) {}
+
+std::optional<FilterCountEntry> FilterCountCache::find(FilterKey const& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) return std::nullopt;
+
+    m_order.splice(m_order.begin(), m_order, it->second);
+    return it->second->entry;
+}
+
+void FilterCountCache::store(FilterKey const& key, FilterCountEntry entry) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        it->second->entry = entry;
+        m_order.splice(m_order.begin(), m_order, it->second);
+    }
+    else {
+        m_order.push_front({ key, entry });
+        m_index[key] = m_order.begin();
+        this->evict();
+    }
+    this->markDirty(entry.updatedAt);
+}
+
+void FilterCountCache::erase(FilterKey const& key, double now) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) return;
+
+    m_order.erase(it->second);
+    m_index.erase(it);
+    this->markDirty(now);
+}
+
+void FilterCountCache::observe(FilterKey const& key, int maxPage, double now) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        this->store(key, { .maxPage = maxPage, .updatedAt = now, .observedSince = now });
+        return;
+    }
+    this->store(key, it->second->entry.observe(maxPage, now));
+}
+
+FilterBounds FilterCountCache::bounds(FilterKey const& key, double now, double maxAge) const {
+    FilterBounds bounds;
+    for (auto const& node : m_order) {
+        if (node.key == key || now - node.entry.updatedAt > maxAge) continue;
+
+        bool infinite = node.entry.maxPage == infinitePage;
+        if (key.narrows(node.key) && !infinite) {
+            bounds.upperPage = std::min(bounds.upperPage.value_or(node.entry.maxPage), node.entry.maxPage);
+        }
+        else if (node.key.narrows(key)) {
+            if (infinite) bounds.infinite = true;
+            else bounds.lowerPage = std::max(bounds.lowerPage, node.entry.maxPage);
+        }
+    }
+    // Entries of different ages can disagree; a contradiction says nothing.
+    if (bounds.upperPage && *bounds.upperPage < bounds.lowerPage) return {};
+    return bounds;
+}
+
+void FilterCountCache::clear() {
+    m_order.clear();
+    m_index.clear();
+    m_pendingChanges = 0;
+}
+
+void FilterCountCache::setCapacity(size_t capacity) {
+    m_capacity = capacity ? capacity : 1;
+    this->evict();
+}
+
+void FilterCountCache::evict() {
+    while (m_index.size() > m_capacity) {
+        m_index.erase(m_order.back().key);
+        m_order.pop_back();
+    }
+}
+
+void FilterCountCache::markDirty(double now) {
+    if (m_pendingChanges == 0) m_firstPendingAt = now;
+    m_pendingChanges++;
+}
+
+bool FilterCountCache::needsFlush(double now, double flushDelay, int flushBatch) const {
+    if (m_pendingChanges == 0) return false;
+    return m_pendingChanges >= flushBatch || now - m_firstPendingAt >= flushDelay;
+}
+
+std::vector<uint8_t> FilterCountCache::serialize() {
+    ByteWriter out;
+    out.put(cacheMagic);
+    out.put(cacheVersion);
+    out.put(static_cast<uint32_t>(m_order.size()));
+
+    // Least recently used first, so loading replays the LRU order.
+    for (auto it = m_order.rbegin(); it != m_order.rend(); ++it) {
+        auto const& key = it->key;
+        out.put(key.difficultyMask);
+        out.put(key.lengthMask);
+        out.put(key.demonFilter);
+        out.put(key.flags);
+        out.put(key.songID);
+        out.put(key.queryHash);
+        out.put(static_cast<int32_t>(it->entry.maxPage));
+        out.put(it->entry.updatedAt);
+        out.put(it->entry.pagesPerDay);
+        out.put(it->entry.observedSince);
+    }
+
+    m_pendingChanges = 0;
+    return out.take();
+}
+
+bool FilterCountCache::deserialize(std::span<uint8_t const> data) {
+    ByteReader in(data);
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint32_t count = 0;
+    if (!in.get(magic) || magic != cacheMagic || !in.get(version) || version != cacheVersion || !in.get(count)) {
+        return false;
+    }
+
+    this->clear();
+    for (uint32_t i = 0; i < count; i++) {
+        FilterKey key;
+        FilterCountEntry entry;
+        int32_t maxPage = 0;
+        in.get(key.difficultyMask);
+        in.get(key.lengthMask);
+        in.get(key.demonFilter);
+        in.get(key.flags);
+        in.get(key.songID);
+        in.get(key.queryHash);
+        in.get(maxPage);
+        in.get(entry.updatedAt);
+        in.get(entry.pagesPerDay);
+        in.get(entry.observedSince);
+        if (!in.ok()) break;
+
+        entry.maxPage = maxPage;
+        m_order.push_front({ key, entry });
+        m_index[key] = m_order.begin();
+        this->evict();
+    }
+
+    m_pendingChanges = 0;
+    return in.ok();
+}
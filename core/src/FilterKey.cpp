@@ -0,0 +1,91 @@
+#include <randomlevel/FilterKey.hpp>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr int difficultyOffset = 3;
+    constexpr int lengthOffset = 0;
+
+    uint64_t mix(uint64_t h, uint64_t value) {
+        h ^= value + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h;
+    }
+}
+
+uint32_t randomlevel::parseFilterList(std::string_view list, int offset) {
+    uint32_t mask = 0;
+    int value = 0;
+    bool negative = false;
+    bool any = false;
+
+    auto flush = [&] {
+        if (any) {
+            int bit = (negative ? -value : value) + offset;
+            if (bit >= 0 && bit < 32) mask |= 1u << bit;
+        }
+        value = 0;
+        negative = false;
+        any = false;
+    };
+
+    for (char c : list) {
+        if (c == ',') flush();
+        else if (c == '-' && !any) negative = true;
+        else if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            any = true;
+        }
+    }
+    flush();
+    return mask;
+}
+
+uint64_t randomlevel::hashBytes(std::string_view bytes) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+FilterKey FilterKey::from(FilterFields const& fields) {
+    FilterKey key;
+    key.difficultyMask = static_cast<uint16_t>(parseFilterList(fields.difficulty, difficultyOffset));
+    key.lengthMask = static_cast<uint8_t>(parseFilterList(fields.length, lengthOffset));
+    key.demonFilter = static_cast<uint8_t>(fields.demonFilter);
+    key.flags = fields.flags;
+    key.songID = fields.songID;
+    key.queryHash = fields.query.empty() ? 0 : hashBytes(fields.query);
+    return key;
+}
+
+uint64_t FilterKey::hash() const {
+    uint64_t h = queryHash;
+    h = mix(h, difficultyMask);
+    h = mix(h, lengthMask);
+    h = mix(h, demonFilter);
+    h = mix(h, flags);
+    h = mix(h, static_cast<uint32_t>(songID));
+    return h;
+}
+
+bool FilterKey::narrows(FilterKey const& other) const {
+    constexpr uint16_t ratingFlags = FeaturedFilter | EpicFilter | LegendaryFilter | MythicFilter;
+
+    auto listNarrows = [](uint32_t mine, uint32_t theirs) {
+        return theirs == 0 || (mine != 0 && (mine & ~theirs) == 0);
+    };
+    if (other.queryHash && other.queryHash != queryHash) return false;
+    if (!listNarrows(difficultyMask, other.difficultyMask) || !listNarrows(lengthMask, other.lengthMask)) return false;
+    if (other.demonFilter && other.demonFilter != demonFilter) return false;
+
+    uint16_t otherRatings = other.flags & ratingFlags;
+    if (otherRatings && otherRatings != (flags & ratingFlags)) return false;
+    uint16_t required = other.flags & ~ratingFlags & ~CustomSongFilter;
+    if ((flags & required) != required) return false;
+
+    bool otherSong = (other.flags & CustomSongFilter) || other.songID > 1;
+    if (otherSong && (((flags ^ other.flags) & CustomSongFilter) || songID != other.songID)) return false;
+    return true;
+}
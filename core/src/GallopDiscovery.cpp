@@ -0,0 +1,172 @@
+#include <randomlevel/GallopDiscovery.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+using namespace randomlevel;
+
+GallopDiscovery::GallopDiscovery(Rng& rng, DiscoveryHints hints)
+    : DiscoveryEngine(rng, std::move(hints)) {}
+
+RollStep GallopDiscovery::startDiscovery() {
+    m_step = 1;
+    m_lastFull = this->hintedLastFull();
+    m_firstEmpty = this->hintedFirstEmpty(glitchPage + 1);
+    m_estimate.reset();
+    m_cachedPage.reset();
+
+    if (m_hints.cachedMaxPage) {
+        int cachedPage = *m_hints.cachedMaxPage;
+        if (cachedPage == 501 || cachedPage >= glitchPage) {
+            note("Cache is " + std::to_string(cachedPage) + " (Infinite/Max). Verifying Glitch Check...");
+            return this->probe(GallopPhase::GlitchCheck, glitchPage, 0.0f);
+        }
+        note("Cache HIT! Peeking at Page " + std::to_string(cachedPage) + "...");
+        m_cachedPage = cachedPage;
+        return this->probe(GallopPhase::Peek, cachedPage, 0.0f);
+    }
+
+    note("Cache MISS. Starting Fresh Discovery.");
+    return this->probe(GallopPhase::CheckTotal, 0, 0.0f);
+}
+
+RollStep GallopDiscovery::onDiscoveryResult(PageResult const& result) {
+    if (result.ok()) return this->onPage(result);
+    if (m_phase == GallopPhase::CheckTotal || !result.maybeEmpty()) {
+        return this->retryOrAbort(this->probe(m_phase, m_page, retryDelay));
+    }
+
+    // Like the bisect search, a probe that may have been empty counts as empty.
+    PageResult empty;
+    empty.status = FetchStatus::Ok;
+    empty.page = result.page;
+    return this->onPage(empty);
+}
+
+std::string_view GallopDiscovery::discoveryPhaseName() const {
+    switch (m_phase) {
+    case GallopPhase::CheckTotal: return "Gallop_CheckTotal";
+    case GallopPhase::GlitchCheck: return "Gallop_GlitchCheck";
+    case GallopPhase::Peek: return "Gallop_Peek";
+    case GallopPhase::GallopUp: return "Gallop_Up";
+    case GallopPhase::GallopDown: return "Gallop_Down";
+    case GallopPhase::Bisect: return "Gallop_Bisect";
+    default: return "Idle";
+    }
+}
+
+RollStep GallopDiscovery::probe(GallopPhase phase, int page, float delay) {
+    m_phase = phase;
+    m_page = page;
+
+    switch (phase) {
+    case GallopPhase::CheckTotal: note("Checking Page 0..."); break;
+    case GallopPhase::GlitchCheck: note("Glitch Check (Page 1000)..."); break;
+    case GallopPhase::Bisect:
+        note("Bisect [" + std::to_string(m_lastFull) + "-" + std::to_string(m_firstEmpty) +
+            "] -> Probing " + std::to_string(page));
+        break;
+    default: note("Probing Page " + std::to_string(page) + "..."); break;
+    }
+    return fetchPage(page, delay);
+}
+
+RollStep GallopDiscovery::onPage(PageResult const& result) {
+    int count = result.count();
+    int page = result.page;
+
+    if (m_phase == GallopPhase::CheckTotal) {
+        if (count == 0) return RollStep::abort("No levels found.");
+        int total = result.total;
+        if (total > 0 && total < 9990) {
+            note("Trusted Total: " + std::to_string(total));
+            return this->prepareTarget((total - 1) / 10, (total - 1) % 10 + 1);
+        }
+        // A clamped total still says the set has at least that many levels.
+        if (total > 0) m_estimate = std::min((total - 1) / 10, glitchPage - 1);
+    }
+
+    if (count > 0 && count < 10) {
+        note("Page " + std::to_string(page) + " not full (Count " + std::to_string(count) + "). Done.");
+        return this->prepareTarget(page, count);
+    }
+
+    if (count > 0) {
+        if (page >= glitchPage) {
+            note("Page 1000+ has levels (Infinite). Capping at 501.");
+            return this->prepareTarget(501, 10);
+        }
+        m_lastFull = std::max(m_lastFull, page);
+    }
+    else {
+        m_firstEmpty = std::min(m_firstEmpty, page);
+    }
+
+    if (m_firstEmpty == m_lastFull + 1) {
+        if (m_lastFull < 0) return RollStep::abort("No levels found.");
+        note("Last page is " + std::to_string(m_lastFull) + " (10 items).");
+        return this->prepareTarget(m_lastFull, 10);
+    }
+
+    switch (m_phase) {
+    case GallopPhase::CheckTotal:
+        if (m_firstEmpty <= glitchPage) {
+            note("The filter ends before Page " + std::to_string(m_firstEmpty) + ". Skipping Glitch Check.");
+            return this->finiteSearch();
+        }
+        return this->probe(GallopPhase::GlitchCheck, glitchPage, safeDelay);
+    case GallopPhase::GlitchCheck:
+        return this->finiteSearch();
+    case GallopPhase::Peek:
+        m_phase = count > 0 ? GallopPhase::GallopUp : GallopPhase::GallopDown;
+        return this->next();
+    case GallopPhase::GallopUp:
+    case GallopPhase::GallopDown:
+        if ((count > 0) != (m_phase == GallopPhase::GallopUp)) m_phase = GallopPhase::Bisect;
+        return this->next();
+    default:
+        return this->next();
+    }
+}
+
+RollStep GallopDiscovery::finiteSearch() {
+    if (m_estimate) {
+        note("Finite Mode. Total hint puts the end near Page " + std::to_string(*m_estimate) + ".");
+        int page = std::clamp(*m_estimate, m_lastFull + 1, m_firstEmpty - 1);
+        return this->probe(GallopPhase::Peek, page, safeDelay);
+    }
+    note("Finite Mode. Bisecting.");
+    return this->probe(GallopPhase::Bisect, m_lastFull + (m_firstEmpty - m_lastFull) / 2, searchDelay);
+}
+
+// Galloping from the cached page only pays while the end is close to it.
+// Past that the cache is stale rather than drifting, and a fresh discovery
+// inside the bracket found so far is cheaper, often a single trusted total.
+RollStep GallopDiscovery::next() {
+    if (m_phase == GallopPhase::GallopUp) {
+        int page = std::min(m_lastFull + m_step, glitchPage);
+        m_step *= 2;
+        if (page < m_firstEmpty && this->beyondCorrection(page)) return this->restartFresh();
+        if (page < m_firstEmpty) return this->probe(GallopPhase::GallopUp, page, searchDelay);
+    }
+    else if (m_phase == GallopPhase::GallopDown) {
+        int page = std::max(m_firstEmpty - m_step, 0);
+        m_step *= 2;
+        if (page > m_lastFull && this->beyondCorrection(page)) return this->restartFresh();
+        if (page > m_lastFull) return this->probe(GallopPhase::GallopDown, page, searchDelay);
+    }
+
+    return this->probe(GallopPhase::Bisect, m_lastFull + (m_firstEmpty - m_lastFull) / 2, searchDelay);
+}
+
+bool GallopDiscovery::beyondCorrection(int page) const {
+    return m_cachedPage && std::abs(page - *m_cachedPage) > correctionPages(*m_cachedPage);
+}
+
+RollStep GallopDiscovery::restartFresh() {
+    note("Cache is off by more than " + std::to_string(correctionPages(*m_cachedPage)) + " pages. Starting Fresh Discovery.");
+    m_cachedPage.reset();
+    m_step = 1;
+    return this->probe(GallopPhase::CheckTotal, 0, safeDelay);
+}
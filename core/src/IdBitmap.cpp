@@ -0,0 +1,182 @@
+#include <randomlevel/IdBitmap.hpp>
+
+#include <algorithm>
+#include <bit>
+
+using namespace randomlevel;
+
+bool IdBitmap::Container::contains(uint16_t low) const {
+    if (this->isBitmap()) return (bits[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool IdBitmap::Container::add(uint16_t low) {
+    if (this->isBitmap()) {
+        auto& word = bits[low >> 6];
+        auto mask = uint64_t(1) << (low & 63);
+        if (word & mask) return false;
+        word |= mask;
+        cardinality++;
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) return false;
+    array.insert(it, low);
+    cardinality++;
+
+    if (cardinality > arrayLimit) {
+        bits.assign(bitmapWords, 0);
+        for (auto value : array) bits[value >> 6] |= uint64_t(1) << (value & 63);
+        array.clear();
+        array.shrink_to_fit();
+    }
+    return true;
+}
+
+bool IdBitmap::Container::remove(uint16_t low) {
+    if (!this->isBitmap()) {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (it == array.end() || *it != low) return false;
+        array.erase(it);
+        cardinality--;
+        return true;
+    }
+
+    auto& word = bits[low >> 6];
+    auto mask = uint64_t(1) << (low & 63);
+    if (!(word & mask)) return false;
+    word &= ~mask;
+    cardinality--;
+
+    if (cardinality <= arrayLimit / 2) {
+        for (uint32_t i = 0; i < bitmapWords; i++) {
+            for (auto w = bits[i]; w; w &= w - 1) array.push_back(uint16_t(i * 64 + std::countr_zero(w)));
+        }
+        bits.clear();
+        bits.shrink_to_fit();
+    }
+    return true;
+}
+
+uint32_t IdBitmap::Container::rank(uint16_t low) const {
+    if (!this->isBitmap()) return uint32_t(std::upper_bound(array.begin(), array.end(), low) - array.begin());
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < (uint32_t)(low >> 6); i++) count += std::popcount(bits[i]);
+    auto bit = low & 63;
+    auto mask = bit == 63 ? ~uint64_t(0) : (uint64_t(1) << (bit + 1)) - 1;
+    return count + std::popcount(bits[low >> 6] & mask);
+}
+
+IdBitmap::Container* IdBitmap::find(uint16_t key) {
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](Container const& c, uint16_t k) { return c.key < k; });
+    return it != m_containers.end() && it->key == key ? &*it : nullptr;
+}
+
+IdBitmap::Container const* IdBitmap::find(uint16_t key) const {
+    return const_cast<IdBitmap*>(this)->find(key);
+}
+
+bool IdBitmap::add(uint32_t id) {
+    uint16_t key = id >> 16;
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](Container const& c, uint16_t k) { return c.key < k; });
+    if (it == m_containers.end() || it->key != key) {
+        it = m_containers.insert(it, Container{});
+        it->key = key;
+    }
+    return it->add(id & 0xffff);
+}
+
+bool IdBitmap::remove(uint32_t id) {
+    auto container = this->find(id >> 16);
+    if (!container || !container->remove(id & 0xffff)) return false;
+    if (container->cardinality == 0) {
+        m_containers.erase(m_containers.begin() + (container - m_containers.data()));
+    }
+    return true;
+}
+
+bool IdBitmap::contains(uint32_t id) const {
+    auto container = this->find(id >> 16);
+    return container && container->contains(id & 0xffff);
+}
+
+void IdBitmap::clear() {
+    m_containers.clear();
+}
+
+uint64_t IdBitmap::size() const {
+    uint64_t total = 0;
+    for (auto const& container : m_containers) total += container.cardinality;
+    return total;
+}
+
+uint64_t IdBitmap::rank(uint32_t id) const {
+    uint16_t key = id >> 16;
+    uint64_t total = 0;
+    for (auto const& container : m_containers) {
+        if (container.key > key) break;
+        total += container.key < key ? container.cardinality : container.rank(id & 0xffff);
+    }
+    return total;
+}
+
+uint32_t IdBitmap::selectAbsent(uint32_t min, uint32_t max, uint64_t k) const {
+    uint64_t before = min > 0 ? this->rank(min - 1) : 0;
+    auto absentUpTo = [&](uint32_t x) { return (uint64_t(x) - min + 1) - (this->rank(x) - before); };
+
+    uint32_t lo = min, hi = max;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (absentUpTo(mid) >= k + 1) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+void IdBitmap::write(ByteWriter& out) const {
+    out.put(static_cast<uint32_t>(m_containers.size()));
+    for (auto const& container : m_containers) {
+        out.put(container.key);
+        out.put(container.cardinality);
+        out.put(static_cast<uint8_t>(container.isBitmap()));
+        if (container.isBitmap()) {
+            for (auto word : container.bits) out.put(word);
+        }
+        else {
+            for (auto value : container.array) out.put(value);
+        }
+    }
+}
+
+bool IdBitmap::read(ByteReader& in) {
+    this->clear();
+
+    uint32_t count = 0;
+    if (!in.get(count)) return false;
+    for (uint32_t i = 0; i < count && in.ok(); i++) {
+        Container container;
+        uint8_t isBitmap = 0;
+        in.get(container.key);
+        in.get(container.cardinality);
+        in.get(isBitmap);
+        if (!in.ok() || container.cardinality == 0 || container.cardinality > 65536) return false;
+        if (!m_containers.empty() && m_containers.back().key >= container.key) return false;
+
+        if (isBitmap) {
+            container.bits.resize(bitmapWords);
+            for (auto& word : container.bits) in.get(word);
+        }
+        else {
+            if (container.cardinality > arrayLimit) return false;
+            container.array.resize(container.cardinality);
+            for (auto& value : container.array) in.get(value);
+            if (!std::is_sorted(container.array.begin(), container.array.end())) return false;
+        }
+        m_containers.push_back(std::move(container));
+    }
+    return in.ok();
+}
@@ -0,0 +1,442 @@
+#include <randomlevel/Binary.hpp>
+#include <randomlevel/LevelIndex.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <string>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr uint32_t indexMagic = 0x494c4c52; // "RLLI"
+    constexpr uint16_t indexVersion = 1;
+    constexpr size_t headerSize = 16;
+
+    // Bitmap order in the file: difficulty (-3..5), demon filter (0..5),
+    // length (0..5), then one per rating flag.
+    constexpr int difficultyBitmaps = 0;
+    constexpr int demonBitmaps = 9;
+    constexpr int lengthBitmaps = 15;
+    constexpr int starBitmap = 21;
+    constexpr int featuredBitmap = 22;
+    constexpr int epicBitmap = 23;
+    constexpr int legendaryBitmap = 24;
+    constexpr int mythicBitmap = 25;
+    constexpr int bitmapCount = 26;
+
+    constexpr std::pair<uint16_t, int> ratingBitmaps[] = {
+        { FeaturedFilter, featuredBitmap },
+        { EpicFilter, epicBitmap },
+        { LegendaryFilter, legendaryBitmap },
+        { MythicFilter, mythicBitmap },
+    };
+
+    size_t bitmapOffset(uint32_t rows) {
+        return (headerSize + (size_t)rows * 12 + 7) & ~size_t(7);
+    }
+
+    int difficultyBit(int difficulty) { return difficulty + 3; }
+
+    bool songFilterActive(FilterKey const& key) {
+        return (key.flags & CustomSongFilter) || key.songID > 1;
+    }
+
+    // The server takes official songs 1-based and only matches levels
+    // without a custom song.
+    bool songMatches(FilterKey const& key, int audioTrack, int customSong) {
+        if (key.flags & CustomSongFilter) return customSong == key.songID;
+        return customSong == 0 && audioTrack == key.songID - 1;
+    }
+
+    bool demonFilterActive(FilterKey const& key) {
+        return key.difficultyMask == (1u << difficultyBit(-2)) && key.demonFilter > 0;
+    }
+
+    std::vector<int> bitmapsOf(IndexedLevel const& level) {
+        std::vector<int> bitmaps = {
+            difficultyBitmaps + difficultyBit(level.difficulty),
+            demonBitmaps + level.demon,
+            lengthBitmaps + level.length,
+        };
+        if (level.flags & StarFilter) bitmaps.push_back(starBitmap);
+        for (auto [flag, bitmap] : ratingBitmaps) {
+            if (level.flags & flag) bitmaps.push_back(bitmap);
+        }
+        return bitmaps;
+    }
+
+    int toInt(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '"')) text.remove_prefix(1);
+        int value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    }
+
+    std::string_view take(std::string_view& rest, char separator) {
+        auto end = rest.find(separator);
+        auto part = rest.substr(0, end);
+        rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+        return part;
+    }
+}
+
+IndexedLevel IndexedLevel::from(LevelFields const& fields) {
+    IndexedLevel level;
+    level.levelID = fields.levelID;
+    level.length = (uint8_t)std::clamp(fields.length, 0, 5);
+    level.audioTrack = fields.audioTrack;
+    level.customSong = fields.customSong;
+
+    if (fields.autoLevel) level.difficulty = -3;
+    else if (fields.demon) level.difficulty = -2;
+    else if (fields.difficulty <= 0) level.difficulty = -1;
+    else level.difficulty = (int8_t)std::clamp(fields.difficulty / 10, 1, 5);
+
+    if (fields.demon) {
+        switch (fields.demonDifficulty) {
+        case 3: level.demon = 1; break;
+        case 4: level.demon = 2; break;
+        case 5: level.demon = 4; break;
+        case 6: level.demon = 5; break;
+        default: level.demon = 3; break;
+        }
+    }
+
+    if (fields.stars > 0) level.flags |= StarFilter;
+    if (fields.featureScore > 0) level.flags |= FeaturedFilter;
+    if (fields.epic == 1) level.flags |= EpicFilter;
+    else if (fields.epic == 2) level.flags |= LegendaryFilter;
+    else if (fields.epic == 3) level.flags |= MythicFilter;
+    return level;
+}
+
+bool IndexedLevel::matches(FilterKey const& key) const {
+    if (key.difficultyMask && !(key.difficultyMask & (1u << difficultyBit(difficulty)))) return false;
+    if (demonFilterActive(key) && demon != key.demonFilter) return false;
+    if (key.lengthMask && !(key.lengthMask & (1u << length))) return false;
+    if ((key.flags & StarFilter) && !(flags & StarFilter)) return false;
+    if ((key.flags & NoStarFilter) && (flags & StarFilter)) return false;
+
+    uint16_t ratings = key.flags & (FeaturedFilter | EpicFilter | LegendaryFilter | MythicFilter);
+    if (ratings && !(flags & ratings)) return false;
+    uint16_t required = key.flags & (OriginalFilter | TwoPlayerFilter | CoinsFilter);
+    if ((flags & required) != required) return false;
+    if (songFilterActive(key) && !songMatches(key, audioTrack, customSong)) return false;
+    return true;
+}
+
+std::optional<std::vector<IndexedLevel>> randomlevel::parseLevelDump(std::string_view csv) {
+    auto header = take(csv, '\n');
+    if (!header.empty() && header.back() == '\r') header.remove_suffix(1);
+
+    std::vector<std::string> columns;
+    while (!header.empty()) {
+        auto name = take(header, ',');
+        std::string column;
+        for (char c : name) {
+            if (c != '"' && c != ' ') column += c;
+        }
+        columns.push_back(std::move(column));
+    }
+    if (std::find(columns.begin(), columns.end(), "id") == columns.end()) return std::nullopt;
+
+    std::vector<IndexedLevel> levels;
+    while (!csv.empty()) {
+        auto line = take(csv, '\n');
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
+
+        LevelFields fields;
+        for (size_t i = 0; i < columns.size() && !line.empty(); i++) {
+            auto const& column = columns[i];
+            int value = toInt(take(line, ','));
+            if (column == "id") fields.levelID = value;
+            else if (column == "difficulty") fields.difficulty = value;
+            else if (column == "demon") fields.demon = value != 0;
+            else if (column == "auto") fields.autoLevel = value != 0;
+            else if (column == "demon_difficulty") fields.demonDifficulty = value;
+            else if (column == "length") fields.length = value;
+            else if (column == "stars") fields.stars = value;
+            else if (column == "featured") fields.featureScore = value;
+            else if (column == "epic") fields.epic = value;
+            else if (column == "song") fields.audioTrack = value;
+            else if (column == "custom_song") fields.customSong = value;
+        }
+        if (fields.levelID > 0) levels.push_back(IndexedLevel::from(fields));
+    }
+    return levels;
+}
+
+std::vector<uint8_t> LevelIndex::build(std::vector<IndexedLevel> levels) {
+    // Later entries win, so a dump can be followed by fresher updates.
+    std::stable_sort(levels.begin(), levels.end(), [](auto const& a, auto const& b) { return a.levelID < b.levelID; });
+    std::vector<IndexedLevel> rows;
+    rows.reserve(levels.size());
+    for (auto const& level : levels) {
+        if (!rows.empty() && rows.back().levelID == level.levelID) rows.back() = level;
+        else rows.push_back(level);
+    }
+
+    auto count = (uint32_t)rows.size();
+    auto words = (count + 63) / 64;
+    std::vector<uint64_t> bitmaps((size_t)bitmapCount * words);
+    for (uint32_t row = 0; row < count; row++) {
+        for (int bitmap : bitmapsOf(rows[row])) {
+            bitmaps[(size_t)bitmap * words + row / 64] |= uint64_t(1) << (row % 64);
+        }
+    }
+
+    ByteWriter out;
+    out.put(indexMagic);
+    out.put(indexVersion);
+    out.put(uint16_t(0));
+    out.put(count);
+    out.put(words);
+    for (auto const& level : rows) out.put((int32_t)level.levelID);
+    for (auto const& level : rows) out.put((int32_t)level.audioTrack);
+    for (auto const& level : rows) out.put((int32_t)level.customSong);
+    while (out.data().size() < bitmapOffset(count)) out.put(uint8_t(0));
+    for (auto word : bitmaps) out.put(word);
+    return out.take();
+}
+
+bool LevelIndex::open(std::filesystem::path const& path) {
+    this->close();
+    if (!m_file.open(path)) return false;
+    if (!this->attach(m_file.data())) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void LevelIndex::close() {
+    m_file.close();
+    m_rows = 0;
+    m_words = 0;
+    m_ids = m_audioTracks = m_customSongs = nullptr;
+    m_bitmaps = nullptr;
+    m_shadowed.clear();
+    m_overlay.clear();
+    m_overlayRows.clear();
+    m_removed.clear();
+    m_pendingChanges = 0;
+}
+
+// Columns are read in place, which needs a little-endian host and the
+// 8-byte alignment the mapping provides.
+bool LevelIndex::attach(std::span<uint8_t const> data) {
+    if constexpr (std::endian::native != std::endian::little) return false;
+
+    ByteReader in(data);
+    uint32_t magic = 0, rows = 0, words = 0;
+    uint16_t version = 0, reserved = 0;
+    if (!in.get(magic) || magic != indexMagic || !in.get(version) || version != indexVersion) return false;
+    if (!in.get(reserved) || !in.get(rows) || !in.get(words) || words != (rows + 63) / 64) return false;
+    if (data.size() != bitmapOffset(rows) + (size_t)bitmapCount * words * 8) return false;
+    if (reinterpret_cast<uintptr_t>(data.data()) % 8 != 0) return false;
+
+    m_rows = rows;
+    m_words = words;
+    m_ids = reinterpret_cast<int32_t const*>(data.data() + headerSize);
+    m_audioTracks = m_ids + rows;
+    m_customSongs = m_audioTracks + rows;
+    m_bitmaps = reinterpret_cast<uint64_t const*>(data.data() + bitmapOffset(rows));
+    m_shadowed.assign(words, 0);
+    return true;
+}
+
+bool LevelIndex::canAnswer(FilterKey const& key) {
+    constexpr uint16_t unindexed = CompletedFilter | UncompletedFilter | OriginalFilter | TwoPlayerFilter | CoinsFilter;
+    return !(key.flags & unindexed) && key.queryHash == 0;
+}
+
+size_t LevelIndex::size() const {
+    size_t shadowed = 0;
+    for (auto word : m_shadowed) shadowed += std::popcount(word);
+    return m_rows - shadowed + m_overlay.size();
+}
+
+std::optional<size_t> LevelIndex::findRow(int levelID) const {
+    auto it = std::lower_bound(m_ids, m_ids + m_rows, levelID);
+    if (it == m_ids + m_rows || *it != levelID) return std::nullopt;
+    return (size_t)(it - m_ids);
+}
+
+bool LevelIndex::hasBit(int bitmap, size_t row) const {
+    return (m_bitmaps[(size_t)bitmap * m_words + row / 64] >> (row % 64)) & 1;
+}
+
+IndexedLevel LevelIndex::baseRow(size_t row) const {
+    IndexedLevel level;
+    level.levelID = m_ids[row];
+    level.audioTrack = m_audioTracks[row];
+    level.customSong = m_customSongs[row];
+    for (int value = -3; value <= 5; value++) {
+        if (this->hasBit(difficultyBitmaps + difficultyBit(value), row)) level.difficulty = (int8_t)value;
+    }
+    for (int value = 0; value <= 5; value++) {
+        if (this->hasBit(demonBitmaps + value, row)) level.demon = (uint8_t)value;
+        if (this->hasBit(lengthBitmaps + value, row)) level.length = (uint8_t)value;
+    }
+    if (this->hasBit(starBitmap, row)) level.flags |= StarFilter;
+    for (auto [flag, bitmap] : ratingBitmaps) {
+        if (this->hasBit(bitmap, row)) level.flags |= flag;
+    }
+    return level;
+}
+
+std::vector<uint64_t> LevelIndex::matchBase(FilterKey const& key) const {
+    std::vector<uint64_t> mask(m_words, ~uint64_t(0));
+    if (m_rows % 64) mask.back() = (uint64_t(1) << (m_rows % 64)) - 1;
+    for (uint32_t i = 0; i < m_words; i++) mask[i] &= ~m_shadowed[i];
+
+    auto bitmap = [&](int index) { return m_bitmaps + (size_t)index * m_words; };
+    auto intersectAny = [&](auto const& indices) {
+        if (indices.empty()) return;
+        for (uint32_t i = 0; i < m_words; i++) {
+            uint64_t any = 0;
+            for (int index : indices) any |= bitmap(index)[i];
+            mask[i] &= any;
+        }
+    };
+
+    std::vector<int> group;
+    for (int bit = 0; bit < 9; bit++) {
+        if (key.difficultyMask & (1u << bit)) group.push_back(difficultyBitmaps + bit);
+    }
+    intersectAny(group);
+
+    group.clear();
+    if (demonFilterActive(key) && key.demonFilter <= 5) group.push_back(demonBitmaps + key.demonFilter);
+    intersectAny(group);
+
+    group.clear();
+    for (int bit = 0; bit < 6; bit++) {
+        if (key.lengthMask & (1u << bit)) group.push_back(lengthBitmaps + bit);
+    }
+    intersectAny(group);
+
+    group.clear();
+    for (auto [flag, index] : ratingBitmaps) {
+        if (key.flags & flag) group.push_back(index);
+    }
+    intersectAny(group);
+
+    if (key.flags & StarFilter) {
+        for (uint32_t i = 0; i < m_words; i++) mask[i] &= bitmap(starBitmap)[i];
+    }
+    if (key.flags & NoStarFilter) {
+        for (uint32_t i = 0; i < m_words; i++) mask[i] &= ~bitmap(starBitmap)[i];
+    }
+
+    if (songFilterActive(key)) {
+        for (uint32_t i = 0; i < m_words; i++) {
+            for (auto word = mask[i]; word; word &= word - 1) {
+                auto row = (size_t)i * 64 + std::countr_zero(word);
+                if (!songMatches(key, m_audioTracks[row], m_customSongs[row])) mask[i] &= ~(uint64_t(1) << (row % 64));
+            }
+        }
+    }
+    return mask;
+}
+
+uint64_t LevelIndex::count(FilterKey const& key) const {
+    uint64_t total = 0;
+    for (auto word : this->matchBase(key)) total += std::popcount(word);
+    for (auto const& level : m_overlay) total += level.matches(key);
+    return total;
+}
+
+std::optional<int> LevelIndex::pick(FilterKey const& key, Rng& rng) const {
+    auto mask = this->matchBase(key);
+    uint64_t baseCount = 0;
+    for (auto word : mask) baseCount += std::popcount(word);
+
+    std::vector<int> overlayHits;
+    for (auto const& level : m_overlay) {
+        if (level.matches(key)) overlayHits.push_back(level.levelID);
+    }
+
+    uint64_t total = baseCount + overlayHits.size();
+    if (total == 0) return std::nullopt;
+
+    auto r = std::uniform_int_distribution<uint64_t>(0, total - 1)(rng.engine());
+    if (r >= baseCount) return overlayHits[r - baseCount];
+
+    for (uint32_t i = 0; i < m_words; i++) {
+        uint64_t bits = std::popcount(mask[i]);
+        if (r >= bits) {
+            r -= bits;
+            continue;
+        }
+        auto word = mask[i];
+        for (; r > 0; r--) word &= word - 1;
+        return m_ids[(size_t)i * 64 + std::countr_zero(word)];
+    }
+    return std::nullopt;
+}
+
+void LevelIndex::update(IndexedLevel const& level) {
+    if (level.levelID <= 0) return;
+    m_removed.erase(level.levelID);
+
+    if (auto it = m_overlayRows.find(level.levelID); it != m_overlayRows.end()) {
+        if (m_overlay[it->second] == level) return;
+        m_overlay[it->second] = level;
+    }
+    else {
+        auto row = this->findRow(level.levelID);
+        if (row && this->baseRow(*row) == level) return;
+        if (row) m_shadowed[*row / 64] |= uint64_t(1) << (*row % 64);
+        m_overlayRows[level.levelID] = m_overlay.size();
+        m_overlay.push_back(level);
+    }
+
+    m_pendingChanges++;
+}
+
+void LevelIndex::remove(int levelID) {
+    bool removed = false;
+    if (auto it = m_overlayRows.find(levelID); it != m_overlayRows.end()) {
+        auto index = it->second;
+        m_overlayRows.erase(it);
+        if (index + 1 != m_overlay.size()) {
+            m_overlay[index] = m_overlay.back();
+            m_overlayRows[m_overlay[index].levelID] = index;
+        }
+        m_overlay.pop_back();
+        removed = true;
+    }
+    if (auto row = this->findRow(levelID)) {
+        auto& word = m_shadowed[*row / 64];
+        auto bit = uint64_t(1) << (*row % 64);
+        removed |= !(word & bit);
+        word |= bit;
+    }
+
+    if (removed) m_pendingChanges++;
+    m_removed.insert(levelID);
+}
+
+LevelIndex::Changes LevelIndex::changes() const {
+    return { m_overlay, std::vector<int>(m_removed.begin(), m_removed.end()) };
+}
+
+void LevelIndex::apply(Changes const& changes) {
+    for (auto const& level : changes.updated) this->update(level);
+    for (int id : changes.removed) this->remove(id);
+}
+
+std::vector<uint8_t> LevelIndex::serialize() {
+    std::vector<IndexedLevel> levels;
+    levels.reserve(this->size());
+    for (size_t row = 0; row < m_rows; row++) {
+        if (!((m_shadowed[row / 64] >> (row % 64)) & 1)) levels.push_back(this->baseRow(row));
+    }
+    levels.insert(levels.end(), m_overlay.begin(), m_overlay.end());
+
+    m_pendingChanges = 0;
+    return build(std::move(levels));
+}
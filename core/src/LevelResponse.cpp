@@ -0,0 +1,139 @@
+#include <randomlevel/LevelResponse.hpp>
+
+#include <charconv>
+
+using namespace randomlevel;
+
+namespace {
+    int toInt(std::string_view text) {
+        int value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    }
+
+    // Splits off the text up to `separator`, advancing `rest` past it.
+    std::string_view take(std::string_view& rest, char separator) {
+        auto end = findByte(rest, separator);
+        auto part = rest.substr(0, end);
+        rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+        return part;
+    }
+
+    TextSpan spanOf(std::string_view part, std::string_view whole) {
+        return { static_cast<uint32_t>(part.data() - whole.data()), static_cast<uint32_t>(part.size()) };
+    }
+
+    bool parseLevel(std::string_view entry, std::string_view whole, LevelSummary& level) {
+        level.raw = spanOf(entry, whole);
+        while (!entry.empty()) {
+            auto key = take(entry, ':');
+            auto value = take(entry, ':');
+            if (key == "1") level.levelID = toInt(value);
+            else if (key == "2") level.name = spanOf(value, whole);
+            else if (key == "6") level.playerID = toInt(value);
+            else if (key == "10") level.downloads = toInt(value);
+            else if (key == "14") level.likes = toInt(value);
+        }
+        return level.levelID > 0;
+    }
+}
+
+std::optional<LevelFields> randomlevel::parseLevelFields(std::string_view entry) {
+    LevelFields fields;
+    while (!entry.empty()) {
+        auto key = take(entry, ':');
+        auto value = toInt(take(entry, ':'));
+        if (key == "1") fields.levelID = value;
+        else if (key == "9") fields.difficulty = value;
+        else if (key == "12") fields.audioTrack = value;
+        else if (key == "15") fields.length = value;
+        else if (key == "17") fields.demon = value != 0;
+        else if (key == "18") fields.stars = value;
+        else if (key == "19") fields.featureScore = value;
+        else if (key == "25") fields.autoLevel = value != 0;
+        else if (key == "35") fields.customSong = value;
+        else if (key == "42") fields.epic = value;
+        else if (key == "43") fields.demonDifficulty = value;
+    }
+    if (fields.levelID <= 0) return std::nullopt;
+    return fields;
+}
+
+CreatorSummary const* LevelPage::creator(int playerID) const {
+    for (auto const& creator : creators) {
+        if (creator.playerID == playerID) return &creator;
+    }
+    return nullptr;
+}
+
+std::string_view PageScan::record(int index) const {
+    if (index < 0 || index >= count) return {};
+    size_t start = 0;
+    for (int i = 0; i < index; i++) start = findByte(levels, '|', start) + 1;
+    auto end = findByte(levels, '|', start);
+    return levels.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+}
+
+std::optional<PageScan> randomlevel::scanLevelPage(std::string_view response) {
+    PageScan scan;
+    if (response.empty()) return std::nullopt;
+    if (response.front() == '-') return scan;
+
+    auto rest = response;
+    scan.levels = take(rest, '#');
+    scan.creators = take(rest, '#');
+    take(rest, '#');
+    auto pageInfo = take(rest, '#');
+    if (pageInfo.empty()) return std::nullopt;
+
+    scan.count = scan.levels.empty() ? 0 : static_cast<int>(countByte(scan.levels, '|')) + 1;
+    scan.total = toInt(take(pageInfo, ':'));
+    scan.offset = toInt(take(pageInfo, ':'));
+    scan.amount = toInt(take(pageInfo, ':'));
+    return scan;
+}
+
+std::optional<std::string_view> randomlevel::levelField(std::string_view entry, std::string_view key) {
+    while (!entry.empty()) {
+        auto name = take(entry, ':');
+        auto value = take(entry, ':');
+        if (name == key) return value;
+    }
+    return std::nullopt;
+}
+
+std::optional<int> randomlevel::levelIntField(std::string_view entry, std::string_view key) {
+    auto value = levelField(entry, key);
+    if (!value) return std::nullopt;
+    return toInt(*value);
+}
+
+std::optional<LevelPage> randomlevel::parseLevelPage(std::string_view response) {
+    auto scan = scanLevelPage(response);
+    if (!scan) return std::nullopt;
+
+    LevelPage page;
+    page.total = scan->total;
+    page.offset = scan->offset;
+    page.amount = scan->amount;
+
+    bool valid = true;
+    page.levels.reserve(scan->count);
+    scan->forEachRecord([&](std::string_view entry) {
+        LevelSummary level;
+        valid = valid && parseLevel(entry, response, level);
+        page.levels.push_back(level);
+    });
+    if (!valid) return std::nullopt;
+
+    auto creators = scan->creators;
+    while (!creators.empty()) {
+        auto entry = take(creators, '|');
+        CreatorSummary creator;
+        creator.playerID = toInt(take(entry, ':'));
+        creator.name = spanOf(take(entry, ':'), response);
+        creator.accountID = toInt(take(entry, ':'));
+        page.creators.push_back(creator);
+    }
+    return page;
+}
@@ -0,0 +1,51 @@
+#include <randomlevel/LocalIndexRoll.hpp>
+
+#include <string>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr float lookupDelay = 0.5f;
+    constexpr int maxRetries = 5;
+}
+
+LocalIndexRoll::LocalIndexRoll(Rng& rng, LevelIndex const& index, FilterKey key)
+    : m_rng(rng), m_index(index), m_key(key) {}
+
+RollTask LocalIndexRoll::run() {
+    this->setPhase("Local_Lookup");
+    m_missing.clear();
+
+    float delay = 0.0f;
+    int retries = 0;
+    for (int picks = 0; picks < maxPicks; picks++) {
+        auto id = m_index.pick(m_key, m_rng);
+        if (!id) co_return this->finish(RollStep::abort("No levels in the local index match these filters."));
+        for (int draw = 0; m_seen && m_seen->contains(*id) && draw < maxSeenDraws; draw++) {
+            id = m_index.pick(m_key, m_rng);
+        }
+        note("Local index picked level " + std::to_string(*id) + ".");
+
+        PageRequest req;
+        req.kind = RequestKind::IdLookup;
+        req.ids.push_back(*id);
+
+        auto result = co_await this->fetch(req, delay);
+        while (!result.ok() && !result.maybeEmpty()) {
+            if (++retries > maxRetries) co_return this->finish(RollStep::abort("Connection Failed or Timed Out."));
+            result = co_await this->fetch(req, lookupDelay);
+        }
+        if (result.ok() && result.count() > 0) co_return this->finish(RollStep::done(result.page, 0));
+
+        note("Level " + std::to_string(*id) + " is gone. Picking another.");
+        // FailedOrEmpty may be a network error, so only clean answers count.
+        if (result.ok()) m_missing.push_back(*id);
+        delay = lookupDelay;
+    }
+    co_return this->finish(RollStep::abort("The local index keeps picking levels that no longer exist."));
+}
+
+RollStep LocalIndexRoll::finish(RollStep step) {
+    if (!m_missing.empty() && m_hooks.levelsMissing) m_hooks.levelsMissing(m_missing);
+    return step;
+}
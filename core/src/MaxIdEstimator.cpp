@@ -0,0 +1,66 @@
+#include <randomlevel/MaxIdEstimator.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace randomlevel;
+
+bool MaxIdEstimator::observe(int levelID, double now) {
+    if (levelID <= 0) return false;
+    if (!m_history.empty()) {
+        auto& last = m_history.back();
+        if (levelID <= last.maxID) return false;
+        if (now - last.time < minSpacing) {
+            last.maxID = levelID;
+            last.time = std::max(last.time, now);
+            this->fit();
+            return true;
+        }
+    }
+
+    m_history.push_back({ now, levelID });
+    if ((int)m_history.size() > maxHistory) m_history.erase(m_history.begin());
+    this->fit();
+    return true;
+}
+
+std::optional<int> MaxIdEstimator::predict(double now) const {
+    if (m_history.empty()) return std::nullopt;
+
+    auto const& last = m_history.back();
+    double elapsed = std::clamp(now - last.time, 0.0, maxExtrapolation);
+    double predicted = last.maxID + std::min(m_rate * elapsed, (double)maxLead);
+    return (int)std::min(predicted, 2147483647.0);
+}
+
+void MaxIdEstimator::restore(std::vector<IdObservation> history) {
+    std::erase_if(history, [](IdObservation const& o) { return o.maxID <= 0 || !std::isfinite(o.time); });
+    std::sort(history.begin(), history.end(), [](auto const& a, auto const& b) { return a.time < b.time; });
+    if ((int)history.size() > maxHistory) history.erase(history.begin(), history.end() - maxHistory);
+    m_history = std::move(history);
+    this->fit();
+}
+
+// Least-squares slope of ID over time. Uploads are steady enough over weeks
+// that a straight line beats anything fancier here.
+void MaxIdEstimator::fit() {
+    m_rate = 0.0;
+    if (m_history.size() < 2 || m_history.back().time - m_history.front().time < minSpacing) return;
+
+    double t0 = m_history.front().time;
+    double meanT = 0.0, meanID = 0.0;
+    for (auto const& o : m_history) {
+        meanT += o.time - t0;
+        meanID += o.maxID;
+    }
+    meanT /= m_history.size();
+    meanID /= m_history.size();
+
+    double covariance = 0.0, variance = 0.0;
+    for (auto const& o : m_history) {
+        double dt = o.time - t0 - meanT;
+        covariance += dt * (o.maxID - meanID);
+        variance += dt * dt;
+    }
+    if (variance > 0.0) m_rate = std::max(0.0, covariance / variance);
+}
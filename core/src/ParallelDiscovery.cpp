@@ -0,0 +1,188 @@
+#include <randomlevel/ParallelDiscovery.hpp>
+
+#include <algorithm>
+#include <string>
+
+using namespace randomlevel;
+
+ParallelDiscovery::ParallelDiscovery(Rng& rng, DiscoveryHints hints, int width)
+    : DiscoveryEngine(rng, std::move(hints)), m_width(std::clamp(width, 2, maxWidth)) {}
+
+RollStep ParallelDiscovery::startDiscovery() {
+    m_lastFull = this->hintedLastFull();
+    m_firstEmpty = this->hintedFirstEmpty(glitchPage + 1);
+    m_estimate.reset();
+
+    if (m_hints.cachedMaxPage) {
+        int cachedPage = *m_hints.cachedMaxPage;
+        if (cachedPage == 501 || cachedPage >= glitchPage) {
+            note("Cache is " + std::to_string(cachedPage) + " (Infinite/Max). Verifying Glitch Check...");
+            return this->round(ParallelPhase::Opening, { glitchPage }, 0.0f);
+        }
+        note("Cache HIT! Peeking at Page " + std::to_string(cachedPage) + "...");
+        return this->round(ParallelPhase::Opening, { cachedPage }, 0.0f);
+    }
+
+    if (m_firstEmpty <= glitchPage) {
+        note("The filter ends before Page " + std::to_string(m_firstEmpty) + ". Checking Page 0...");
+        return this->round(ParallelPhase::Opening, { 0 }, 0.0f);
+    }
+    note("Checking Page 0 and Glitch Page together...");
+    return this->round(ParallelPhase::Opening, { 0, glitchPage }, 0.0f);
+}
+
+RollStep ParallelDiscovery::onDiscoveryResult(PageResult const& result) {
+    m_results.push_back(result);
+    if (m_results.size() < m_pages.size()) return RollStep::wait();
+    return this->evaluate();
+}
+
+std::string_view ParallelDiscovery::discoveryPhaseName() const {
+    switch (m_phase) {
+    case ParallelPhase::Opening: return "Parallel_Opening";
+    case ParallelPhase::Ladder: return "Parallel_Ladder";
+    case ParallelPhase::Split: return "Parallel_Split";
+    default: return "Idle";
+    }
+}
+
+RollStep ParallelDiscovery::round(ParallelPhase phase, std::vector<int> pages, float delay) {
+    m_phase = phase;
+    m_pages = std::move(pages);
+    m_results.clear();
+
+    if (phase != ParallelPhase::Opening) {
+        std::string list;
+        for (int page : m_pages) list += (list.empty() ? "" : ", ") + std::to_string(page);
+        note("Bracket [" + std::to_string(m_lastFull) + "-" + std::to_string(m_firstEmpty) + "] -> Probing " + list);
+    }
+
+    std::vector<PageRequest> requests;
+    for (int page : m_pages) requests.push_back(pageRequest(page));
+    return RollStep::fetchAll(std::move(requests), delay);
+}
+
+RollStep ParallelDiscovery::evaluate() {
+    auto results = std::move(m_results);
+    m_results.clear();
+    std::sort(results.begin(), results.end(), [](auto const& a, auto const& b) { return a.page < b.page; });
+
+    bool anyOk = false;
+    bool glitch = false;
+    int partialPage = -1;
+    int partialCount = 0;
+    int roundFull = m_lastFull;
+
+    for (auto& result : results) {
+        if (result.maybeEmpty() && !(m_phase == ParallelPhase::Opening && result.page == 0)) {
+            result.status = FetchStatus::Ok;
+            result.levelIDs.clear();
+        }
+        if (!result.ok()) continue;
+        anyOk = true;
+        int count = result.count();
+
+        if (m_phase == ParallelPhase::Opening && result.page == 0) {
+            if (count == 0) return RollStep::abort("No levels found.");
+            int total = result.total;
+            if (total > 0 && total < 9990) {
+                note("Trusted Total: " + std::to_string(total));
+                return this->prepareTarget((total - 1) / 10, (total - 1) % 10 + 1);
+            }
+            if (total > 0) m_estimate = std::min((total - 1) / 10, glitchPage - 1);
+        }
+
+        if (count > 0 && result.page >= glitchPage) glitch = true;
+        else if (count > 0 && count < 10 && partialPage < 0) {
+            partialPage = result.page;
+            partialCount = count;
+        }
+        else if (count == 10) roundFull = std::max(roundFull, result.page);
+    }
+
+    if (!anyOk) return this->retryOrAbort(this->round(m_phase, m_pages, retryDelay));
+
+    if (glitch) {
+        note("Glitch Detected (Page 1000 has levels). Capping 501.");
+        return this->prepareTarget(501, 10);
+    }
+    if (partialPage >= 0) {
+        note("Page " + std::to_string(partialPage) + " not full (Count " + std::to_string(partialCount) + "). Done.");
+        return this->prepareTarget(partialPage, partialCount);
+    }
+
+    // An empty page below a full one is a bad response; the full page wins.
+    m_lastFull = roundFull;
+    for (auto const& result : results) {
+        if (result.ok() && result.count() == 0 && result.page > m_lastFull) {
+            m_firstEmpty = std::min(m_firstEmpty, result.page);
+        }
+    }
+    if (m_firstEmpty <= m_lastFull) m_firstEmpty = glitchPage + 1;
+
+    if (m_firstEmpty == m_lastFull + 1) {
+        if (m_lastFull < 0) return RollStep::abort("No levels found.");
+        note("Last page is " + std::to_string(m_lastFull) + " (10 items).");
+        return this->prepareTarget(m_lastFull, 10);
+    }
+
+    if (m_firstEmpty > glitchPage && m_lastFull >= 0) {
+        return this->round(ParallelPhase::Ladder, this->ladderUp(), searchDelay);
+    }
+    if (m_lastFull < 0 && m_firstEmpty <= glitchPage) {
+        return this->round(ParallelPhase::Ladder, this->ladderDown(), searchDelay);
+    }
+    if (m_estimate && *m_estimate > m_lastFull && *m_estimate < m_firstEmpty) {
+        note("Total hint puts the end near Page " + std::to_string(*m_estimate) + ".");
+        auto pages = this->around(*m_estimate);
+        m_estimate.reset();
+        return this->round(ParallelPhase::Ladder, std::move(pages), searchDelay);
+    }
+    return this->round(ParallelPhase::Split, this->split(), searchDelay);
+}
+
+// Without a known end (the glitch check failed) the top rung goes back to the
+// glitch page; otherwise the rungs would only creep up a few pages a round.
+std::vector<int> ParallelDiscovery::ladderUp() const {
+    std::vector<int> pages;
+    for (int i = 0, step = 1; i < m_width; i++, step *= 2) {
+        int page = std::min(m_lastFull + step, glitchPage);
+        if (page >= m_firstEmpty || (!pages.empty() && pages.back() == page)) break;
+        pages.push_back(page);
+    }
+    if (m_firstEmpty > glitchPage && !pages.empty()) pages.back() = glitchPage;
+    return pages;
+}
+
+std::vector<int> ParallelDiscovery::ladderDown() const {
+    std::vector<int> pages;
+    for (int i = 0, step = 1; i < m_width; i++, step *= 2) {
+        int page = std::max(m_firstEmpty - step, 0);
+        if (page <= m_lastFull || (!pages.empty() && pages.back() == page)) break;
+        pages.push_back(page);
+    }
+    return pages;
+}
+
+// The hinted page and its neighbours settle the end in one round when the
+// total was close; otherwise they still narrow the bracket.
+std::vector<int> ParallelDiscovery::around(int page) const {
+    std::vector<int> pages;
+    for (int p = page - 1; p <= page + 1 && (int)pages.size() < m_width; p++) {
+        if (p > m_lastFull && p < m_firstEmpty) pages.push_back(p);
+    }
+    return pages;
+}
+
+std::vector<int> ParallelDiscovery::split() const {
+    std::vector<int> pages;
+    int gap = m_firstEmpty - m_lastFull;
+    for (int i = 1; i <= m_width; i++) {
+        int page = m_lastFull + (int)((long long)gap * i / (m_width + 1));
+        if (page <= m_lastFull || page >= m_firstEmpty) continue;
+        if (!pages.empty() && pages.back() == page) continue;
+        pages.push_back(page);
+    }
+    if (pages.empty()) pages.push_back(m_lastFull + gap / 2);
+    return pages;
+}
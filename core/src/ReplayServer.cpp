@@ -0,0 +1,127 @@
+#include <randomlevel/LevelResponse.hpp>
+#include <randomlevel/ReplayServer.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr std::string_view keyPrefix = "# key ";
+}
+
+std::optional<ResponseFixture> randomlevel::parseFixture(std::string_view text, std::string name) {
+    ResponseFixture fixture;
+    fixture.name = std::move(name);
+
+    while (!text.empty()) {
+        auto end = text.find('\n');
+        auto line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty() || line.front() == '#') continue;
+
+        auto tab = line.find('\t');
+        if (tab == std::string_view::npos) return std::nullopt;
+        int page = -1;
+        auto [ptr, ec] = std::from_chars(line.data(), line.data() + tab, page);
+        if (ec != std::errc() || ptr != line.data() + tab || page < 0) return std::nullopt;
+        fixture.responses[page].emplace_back(line.substr(tab + 1));
+    }
+    return fixture;
+}
+
+std::string randomlevel::fixtureLine(int page, std::string_view body) {
+    std::string line = std::to_string(page) + "\t";
+    for (char c : body) {
+        if (c != '\n' && c != '\r') line += c;
+    }
+    return line + "\n";
+}
+
+std::string randomlevel::fixtureKeyLine(FilterKey const& key) {
+    return std::string(keyPrefix) + std::to_string(key.difficultyMask) + " " + std::to_string(key.lengthMask) + " "
+        + std::to_string(key.demonFilter) + " " + std::to_string(key.flags) + " " + std::to_string(key.songID) + " "
+        + std::to_string(key.queryHash) + "\n";
+}
+
+ReplayServer::ReplayServer(SimClock& clock, ResponseFixture fixture, ReplayConfig config)
+    : m_clock(clock), m_config(config), m_rng(config.seed) {
+    for (auto& [page, bodies] : fixture.responses) {
+        for (auto const& body : bodies) {
+            auto result = this->fromBody(page, body);
+            if (!result.ok()) continue;
+            if (result.total > 0) m_total = result.total;
+            if (result.count() == 0) continue;
+            if (page >= 1000) m_infinite = true;
+            else if (page > m_lastPage) {
+                m_lastPage = page;
+                m_lastCount = result.count();
+            }
+        }
+        m_pages[page].bodies = std::move(bodies);
+    }
+}
+
+void ReplayServer::rewind() {
+    for (auto& [page, state] : m_pages) {
+        state.next = 0;
+        state.lastGood.reset();
+    }
+}
+
+void ReplayServer::fetch(PageRequest const& request, Callback callback) {
+    m_requestCount++;
+
+    double latency = m_config.latency;
+    if (m_config.latencyJitter > 0.0) latency += m_config.latencyJitter * m_rng.uniformReal();
+
+    PageResult result;
+    result.page = request.page;
+    if (request.kind == RequestKind::FilterPage) result = this->respond(request.page);
+    if (m_config.emptyAsFailure && result.ok() && result.count() == 0) result.status = FetchStatus::FailedOrEmpty;
+
+    auto generation = m_generation;
+    m_clock.post(latency, [this, generation, callback = std::move(callback), result = std::move(result)]() {
+        if (generation == m_generation) callback(result);
+    });
+}
+
+PageResult ReplayServer::respond(int page) {
+    auto it = m_pages.find(page);
+    if (it == m_pages.end()) return this->synthesize(page);
+
+    auto& state = it->second;
+    if (state.next < state.bodies.size()) {
+        auto result = this->fromBody(page, state.bodies[state.next++]);
+        if (result.ok()) state.lastGood = result;
+        return result;
+    }
+    return state.lastGood ? *state.lastGood : this->synthesize(page);
+}
+
+PageResult ReplayServer::fromBody(int page, std::string_view body) const {
+    PageResult result;
+    result.page = page;
+    auto parsed = parseLevelPage(body);
+    if (!parsed) return result;
+
+    result.status = FetchStatus::Ok;
+    result.total = parsed->total;
+    for (auto const& level : parsed->levels) result.levelIDs.push_back(level.levelID);
+    return result;
+}
+
+// Made-up pages get made-up IDs, outside the range real levels use.
+PageResult ReplayServer::synthesize(int page) const {
+    PageResult result;
+    result.status = FetchStatus::Ok;
+    result.page = page;
+    result.total = m_total;
+
+    int count = 0;
+    if (m_infinite || page < m_lastPage) count = 10;
+    else if (page == m_lastPage) count = m_lastCount;
+    for (int i = 0; i < count; i++) result.levelIDs.push_back(-(page * 10 + i + 1));
+    return result;
+}
@@ -0,0 +1,66 @@
+#include <randomlevel/RequestScheduler.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace randomlevel;
+
+RequestScheduler::RequestScheduler(SchedulerConfig config)
+    : m_config(config), m_rate(config.initialRate), m_tokens(config.burst) {}
+
+void RequestScheduler::refill(double now) {
+    if (m_lastRefill == 0.0) m_lastRefill = now;
+    if (now > m_lastRefill) {
+        m_tokens = std::min(m_config.burst, m_tokens + (now - m_lastRefill) * m_rate);
+        m_lastRefill = now;
+    }
+}
+
+double RequestScheduler::reserve(double now) {
+    this->refill(now);
+
+    double wait = m_tokens >= 1.0 ? 0.0 : (1.0 - m_tokens) / m_rate;
+    m_tokens -= 1.0;
+
+    return std::max(wait, m_pausedUntil - now);
+}
+
+void RequestScheduler::onSuccess(double now, double latency) {
+    this->refill(now);
+    m_consecutiveFailures = 0;
+
+    if (latency > m_config.latencyTarget) {
+        m_rate = std::max(m_config.minRate, m_rate * m_config.slowDecrease);
+    }
+    else {
+        m_rate = std::min(m_config.maxRate, m_rate + m_config.additiveIncrease);
+    }
+}
+
+void RequestScheduler::onFailure(double now) {
+    this->refill(now);
+    m_consecutiveFailures++;
+    m_rate = std::max(m_config.minRate, m_rate * m_config.multiplicativeDecrease);
+
+    double cooldown = m_config.baseCooldown * std::pow(2.0, std::min(m_consecutiveFailures - 1, 16));
+    m_pausedUntil = std::max(m_pausedUntil, now + std::min(cooldown, m_config.maxCooldown));
+}
+
+SchedulerState RequestScheduler::save(double now) const {
+    SchedulerState state;
+    state.rate = m_rate;
+    state.tokens = m_tokens;
+    state.pausedUntil = m_pausedUntil;
+    state.savedAt = now;
+    return state;
+}
+
+void RequestScheduler::restore(SchedulerState const& state, double now) {
+    if (state.rate <= 0.0 || state.savedAt <= 0.0 || state.savedAt > now) return;
+
+    m_rate = std::clamp(state.rate, m_config.minRate, m_config.maxRate);
+    m_tokens = std::min(m_config.burst, state.tokens + (now - state.savedAt) * m_rate);
+    m_lastRefill = now;
+    m_pausedUntil = state.pausedUntil > now ? state.pausedUntil : 0.0;
+    m_consecutiveFailures = 0;
+}
@@ -0,0 +1,161 @@
+#include <randomlevel/RollDriver.hpp>
+
+#include <utility>
+
+using namespace randomlevel;
+
+RollDriver::RollDriver(PageFetcher& fetcher, Timer& timer)
+    : m_fetcher(fetcher), m_timer(timer) {}
+
+void RollDriver::run(RollEngine& engine, Completion completion) {
+    this->cancel();
+
+    m_engine = &engine;
+    m_completion = std::move(completion);
+    m_stats = RollStats{};
+    m_stats.startTime = m_timer.now();
+
+    this->apply(engine.start());
+}
+
+void RollDriver::cancel() {
+    m_generation++;
+    if (m_engine) {
+        m_timer.cancel();
+        m_fetcher.cancel();
+    }
+    m_engine = nullptr;
+    m_completion = nullptr;
+    m_queue.clear();
+    m_waiting = false;
+    m_inFlight = 0;
+    m_pacedBeforeNext = 0.0;
+}
+
+void RollDriver::apply(RollStep step) {
+    switch (step.kind) {
+    case RollStep::Kind::Fetch: {
+        for (auto& request : step.requests) m_queue.push_back(std::move(request));
+        this->pump(step.delay);
+        return;
+    }
+    case RollStep::Kind::Wait:
+        return;
+    case RollStep::Kind::Done: {
+        RollOutcome outcome;
+        outcome.success = true;
+        outcome.page = step.page;
+        outcome.slot = step.slot;
+        outcome.picks = std::move(step.picks);
+        this->finish(std::move(outcome));
+        return;
+    }
+    case RollStep::Kind::Abort: {
+        RollOutcome outcome;
+        outcome.reason = std::move(step.reason);
+        this->finish(std::move(outcome));
+        return;
+    }
+    }
+}
+
+// Sends queued requests one at a time: the timer only holds one callback, so
+// each request waits for its own delay before the next one is reserved.
+void RollDriver::pump(double fixedDelay) {
+    auto generation = m_generation;
+    while (!m_queue.empty() && !m_waiting && generation == m_generation) {
+        if (this->answerLocally()) continue;
+        double delay = m_scheduler ? m_scheduler->reserve(m_timer.now()) : fixedDelay;
+        fixedDelay = 0.0;
+        if (delay <= 0.0) {
+            this->issueNext();
+            continue;
+        }
+        m_stats.delayTime += delay;
+        m_pacedBeforeNext += delay;
+        m_waiting = true;
+        m_timer.after(delay, [this, generation] {
+            if (generation != m_generation) return;
+            m_waiting = false;
+            this->issueNext();
+            this->pump(0.0);
+        });
+    }
+}
+
+void RollDriver::issueNext() {
+    auto request = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    m_stats.requests++;
+    m_stats.requestsByPhase[std::string(m_engine->phaseName())]++;
+    m_inFlight++;
+    this->logRequest(request);
+
+    auto generation = m_generation;
+    auto sentAt = m_timer.now();
+    auto logIndex = m_stats.requestLog.size() - 1;
+    m_fetcher.fetch(request, [this, generation, sentAt, logIndex](PageResult result) {
+        if (generation != m_generation || !m_engine) return;
+        m_inFlight--;
+        auto now = m_timer.now();
+        auto& record = m_stats.requestLog[logIndex];
+        record.answeredAt = now;
+        record.status = result.status;
+        record.answered = true;
+        if (!result.ok()) m_stats.failures++;
+        if (m_scheduler) {
+            // FailedOrEmpty is the server's "-1", which discovery gets on
+            // purpose past the last page; only a failed request backs off.
+            if (result.ok()) m_scheduler->onSuccess(now, now - sentAt);
+            else if (!result.maybeEmpty()) m_scheduler->onFailure(now);
+        }
+        this->apply(m_engine->onResult(result));
+    });
+}
+
+bool RollDriver::answerLocally() {
+    auto result = m_fetcher.lookup(m_queue.front());
+    if (!result) return false;
+    auto request = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    m_stats.localHits++;
+    auto& record = this->logRequest(request);
+    record.answeredAt = record.sentAt;
+    record.status = result->status;
+    record.local = true;
+    record.answered = true;
+    this->apply(m_engine->onResult(*result));
+    return true;
+}
+
+RequestRecord& RollDriver::logRequest(PageRequest const& request) {
+    auto& record = m_stats.requestLog.emplace_back();
+    record.phase = m_engine->phaseName();
+    record.kind = request.kind;
+    record.page = request.page;
+    record.sentAt = m_timer.now();
+    record.paced = std::exchange(m_pacedBeforeNext, 0.0);
+    return record;
+}
+
+void RollDriver::finish(RollOutcome outcome) {
+    m_stats.endTime = m_timer.now();
+    m_stats.cache = m_engine->cacheUse();
+    m_stats.invalidations = m_engine->invalidations();
+    outcome.stats = m_stats;
+
+    if (m_waiting) m_timer.cancel();
+    if (m_inFlight > 0) m_fetcher.cancel();
+    m_queue.clear();
+    m_waiting = false;
+    m_inFlight = 0;
+
+    auto completion = std::move(m_completion);
+    m_engine = nullptr;
+    m_completion = nullptr;
+    m_generation++;
+
+    if (completion) completion(outcome);
+}
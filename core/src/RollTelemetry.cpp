@@ -0,0 +1,145 @@
+#include <randomlevel/RollTelemetry.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    char const* kindName(RequestKind kind) {
+        switch (kind) {
+        case RequestKind::IdLookup: return "id-lookup";
+        case RequestKind::Recent: return "recent";
+        default: return "filter-page";
+        }
+    }
+
+    char const* statusName(FetchStatus status) {
+        switch (status) {
+        case FetchStatus::Ok: return "ok";
+        case FetchStatus::FailedOrEmpty: return "failed-or-empty";
+        default: return "failed";
+        }
+    }
+
+    char const* cacheName(CacheUse cache) {
+        switch (cache) {
+        case CacheUse::Hit: return "hit";
+        case CacheUse::Miss: return "miss";
+        default: return "none";
+        }
+    }
+
+    // Names come from phase names and mode labels, but stay valid JSON
+    // whatever they hold.
+    void appendString(std::string& out, std::string_view text) {
+        out += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            out += c;
+        }
+        out += '"';
+    }
+
+    void appendEvent(std::string& out, std::string_view name, char phase, double start, double duration, int tid,
+        std::string const& args) {
+        char buffer[128];
+        if (out.back() != '[') out += ",\n";
+        out += "{\"name\":";
+        appendString(out, name);
+        std::snprintf(buffer, sizeof(buffer), ",\"ph\":\"%c\",\"ts\":%.0f,\"pid\":1,\"tid\":%d", phase, start * 1e6, tid);
+        out += buffer;
+        if (phase == 'X') {
+            std::snprintf(buffer, sizeof(buffer), ",\"dur\":%.0f", std::max(duration, 0.0) * 1e6);
+            out += buffer;
+        }
+        if (phase == 'i') out += ",\"s\":\"t\"";
+        out += ",\"args\":{" + args + "}}";
+    }
+
+    void appendThreadName(std::string& out, int tid, std::string const& name) {
+        if (out.back() != '[') out += ",\n";
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"args\":{\"name\":";
+        appendString(out, name);
+        out += "}}";
+    }
+}
+
+void TelemetryCounters::add(RollRecord const& record) {
+    auto const& stats = record.stats;
+    rolls++;
+    if (record.success) successes++;
+    requests += stats.requests;
+    localHits += stats.localHits;
+    failures += stats.failures;
+    if (stats.cache == CacheUse::Hit) cacheHits++;
+    else if (stats.cache == CacheUse::Miss) cacheMisses++;
+    invalidations += stats.invalidations;
+    rollTime += stats.elapsed();
+    pacingTime += stats.delayTime;
+    rollsByMode[record.mode]++;
+
+    for (auto const& request : stats.requestLog) {
+        if (request.local) continue;
+        auto& phase = phases[request.phase];
+        phase.requests++;
+        if (!request.answered || request.status != FetchStatus::Ok) phase.failures++;
+        phase.latency += (request.answered ? request.answeredAt : stats.endTime) - request.sentAt;
+        phase.paced += request.paced;
+    }
+}
+
+void RollTelemetry::record(RollRecord record) {
+    m_counters.add(record);
+    if (m_keepRolls == 0) return;
+    m_recent.push_back(std::move(record));
+    while (m_recent.size() > m_keepRolls) m_recent.pop_front();
+}
+
+std::string RollTelemetry::chromeTrace() const {
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    appendThreadName(out, 1, "Rolls");
+
+    // Requests overlap freely, so each goes on the first track that is free
+    // when it is sent; a track's spans then never overlap.
+    std::vector<double> trackEnds;
+    for (auto const& roll : m_recent) {
+        auto const& stats = roll.stats;
+        char hash[24];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(roll.filterHash));
+        std::string args = "\"filter\":\"" + std::string(hash) + "\",\"success\":" + (roll.success ? "true" : "false") +
+            ",\"requests\":" + std::to_string(stats.requests) + ",\"localHits\":" + std::to_string(stats.localHits) +
+            ",\"failures\":" + std::to_string(stats.failures) + ",\"cache\":\"" + cacheName(stats.cache) +
+            "\",\"invalidations\":" + std::to_string(stats.invalidations);
+        appendEvent(out, roll.mode + " roll", 'X', stats.startTime, stats.elapsed(), 1, args);
+
+        for (auto const& request : stats.requestLog) {
+            std::string requestArgs = "\"page\":" + std::to_string(request.page) + ",\"kind\":\"" +
+                kindName(request.kind) + "\",\"status\":\"" +
+                (request.answered ? statusName(request.status) : "cancelled") + "\"";
+            if (request.paced > 0.0) {
+                appendEvent(out, "pacing", 'X', request.sentAt - request.paced, request.paced, 1, "");
+            }
+            if (request.local) {
+                appendEvent(out, request.phase + " (stored)", 'i', request.sentAt, 0.0, 2, requestArgs);
+                continue;
+            }
+
+            double end = request.answered ? request.answeredAt : stats.endTime;
+            size_t track = 0;
+            while (track < trackEnds.size() && trackEnds[track] > request.sentAt) track++;
+            if (track == trackEnds.size()) {
+                trackEnds.push_back(0.0);
+                appendThreadName(out, 2 + static_cast<int>(track), "Requests " + std::to_string(track + 1));
+            }
+            trackEnds[track] = end;
+            appendEvent(out, request.phase, 'X', request.sentAt, end - request.sentAt, 2 + static_cast<int>(track), requestArgs);
+        }
+    }
+
+    out += "]}\n";
+    return out;
+}
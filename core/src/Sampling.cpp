@@ -0,0 +1,25 @@
+#include <randomlevel/Sampling.hpp>
+
+#include <algorithm>
+#include <unordered_set>
+
+using namespace randomlevel;
+
+std::vector<int> randomlevel::sampleDistinct(Rng& rng, int min, int max, int count) {
+    std::vector<int> out;
+    if (max < min || count <= 0) return out;
+
+    long long range = (long long)max - min + 1;
+    int wanted = (int)std::min<long long>(count, range);
+    out.reserve(wanted);
+
+    std::unordered_set<int> chosen;
+    chosen.reserve(wanted * 2);
+    for (long long j = range - wanted; j < range; j++) {
+        int t = min + (int)std::uniform_int_distribution<long long>(0, j)(rng.engine());
+        int value = chosen.count(t) ? min + (int)j : t;
+        chosen.insert(value);
+        out.push_back(value);
+    }
+    return out;
+}
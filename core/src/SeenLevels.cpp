@@ -0,0 +1,177 @@
+#include <randomlevel/Binary.hpp>
+#include <randomlevel/SeenLevels.hpp>
+
+#include <algorithm>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr uint32_t seenMagic = 0x4e534c52; // "RLSN"
+    constexpr uint16_t seenVersion = 1;
+    // 10 bits and 7 probes per ID keep false positives under 1%.
+    constexpr size_t bitsPerID = 10;
+    constexpr int probes = 7;
+    // Guards the allocation against a damaged file.
+    constexpr uint32_t maxStoredCapacity = 1u << 24;
+
+    uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    size_t wordsFor(size_t capacity) {
+        return (capacity * bitsPerID + 63) / 64;
+    }
+
+    // Probe i of a hash is h1 + i * h2 (double hashing).
+    template <class Visit>
+    bool forEachProbe(uint64_t hash, size_t bitCount, Visit visit) {
+        uint64_t h2 = splitmix64(hash) | 1;
+        for (int i = 0; i < probes; i++) {
+            if (!visit((hash + i * h2) % bitCount)) return false;
+        }
+        return true;
+    }
+}
+
+bool SeenLevels::Generation::contains(uint64_t hash) const {
+    if (bits.empty()) return false;
+    return forEachProbe(hash, bits.size() * 64, [&](uint64_t bit) {
+        return (bits[bit / 64] >> (bit % 64) & 1) != 0;
+    });
+}
+
+void SeenLevels::Generation::insert(uint64_t hash) {
+    if (bits.empty()) return;
+    forEachProbe(hash, bits.size() * 64, [&](uint64_t bit) {
+        bits[bit / 64] |= 1ull << (bit % 64);
+        return true;
+    });
+    count++;
+}
+
+SeenLevels::SeenLevels(size_t capacity) : m_capacity(capacity) {
+    this->reset();
+}
+
+void SeenLevels::reset() {
+    m_current = { std::vector<uint64_t>(wordsFor(m_capacity)), 0 };
+    m_previous = { std::vector<uint64_t>(wordsFor(m_capacity)), 0 };
+    m_recent.clear();
+    m_recentNext = 0;
+}
+
+void SeenLevels::insert(int levelID, double now) {
+    if (m_capacity == 0 || levelID <= 0) return;
+    if (std::find(m_recent.begin(), m_recent.end(), levelID) != m_recent.end()) return;
+
+    this->add(levelID);
+    if (m_pendingChanges == 0) m_firstPendingAt = now;
+    m_pendingChanges++;
+}
+
+// Seeing a level again puts it in the current generation, so it outlives the
+// next rotation.
+void SeenLevels::add(int levelID) {
+    if (m_recent.size() < recentCapacity) {
+        m_recent.push_back(levelID);
+    }
+    else {
+        m_recent[m_recentNext] = levelID;
+        m_recentNext = (m_recentNext + 1) % recentCapacity;
+    }
+
+    if (m_current.count >= m_capacity) {
+        m_previous = std::move(m_current);
+        m_current = { std::vector<uint64_t>(wordsFor(m_capacity)), 0 };
+    }
+    m_current.insert(splitmix64(static_cast<uint64_t>(levelID)));
+}
+
+bool SeenLevels::contains(int levelID) const {
+    if (m_capacity == 0 || levelID <= 0) return false;
+    if (std::find(m_recent.begin(), m_recent.end(), levelID) != m_recent.end()) return true;
+
+    auto hash = splitmix64(static_cast<uint64_t>(levelID));
+    return m_current.contains(hash) || m_previous.contains(hash);
+}
+
+void SeenLevels::clear() {
+    this->reset();
+    m_pendingChanges = 0;
+}
+
+void SeenLevels::setCapacity(size_t capacity) {
+    if (capacity == m_capacity) return;
+
+    std::vector<int> recent(m_recent.begin() + m_recentNext, m_recent.end());
+    recent.insert(recent.end(), m_recent.begin(), m_recent.begin() + m_recentNext);
+    m_capacity = capacity;
+    this->reset();
+    if (m_capacity > 0) {
+        for (int id : recent) this->add(id);
+    }
+    m_pendingChanges++;
+}
+
+size_t SeenLevels::memoryBytes() const {
+    return (m_current.bits.size() + m_previous.bits.size()) * sizeof(uint64_t) + m_recent.capacity() * sizeof(int);
+}
+
+bool SeenLevels::needsFlush(double now, double flushDelay, int flushBatch) const {
+    if (m_pendingChanges == 0) return false;
+    return m_pendingChanges >= flushBatch || now - m_firstPendingAt >= flushDelay;
+}
+
+std::vector<uint8_t> SeenLevels::serialize() {
+    ByteWriter out;
+    out.put(seenMagic);
+    out.put(seenVersion);
+    out.put(static_cast<uint32_t>(m_capacity));
+
+    // Oldest first, so loading replays the ring in order.
+    out.put(static_cast<uint32_t>(m_recent.size()));
+    for (size_t i = 0; i < m_recent.size(); i++) {
+        out.put(static_cast<int32_t>(m_recent[(m_recentNext + i) % m_recent.size()]));
+    }
+    for (auto const* generation : { &m_current, &m_previous }) {
+        out.put(generation->count);
+        for (auto word : generation->bits) out.put(word);
+    }
+
+    m_pendingChanges = 0;
+    return out.take();
+}
+
+bool SeenLevels::deserialize(std::span<uint8_t const> data) {
+    ByteReader in(data);
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint32_t capacity = 0;
+    uint32_t recentCount = 0;
+    if (!in.get(magic) || magic != seenMagic || !in.get(version) || version != seenVersion ||
+        !in.get(capacity) || capacity > maxStoredCapacity || !in.get(recentCount) || recentCount > recentCapacity) {
+        return false;
+    }
+
+    m_capacity = capacity;
+    this->reset();
+    m_pendingChanges = 0;
+    for (uint32_t i = 0; i < recentCount; i++) {
+        int32_t id = 0;
+        in.get(id);
+        m_recent.push_back(id);
+    }
+    for (auto* generation : { &m_current, &m_previous }) {
+        in.get(generation->count);
+        for (auto& word : generation->bits) in.get(word);
+    }
+
+    if (!in.ok()) {
+        this->clear();
+        return false;
+    }
+    return true;
+}
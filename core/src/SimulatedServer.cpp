@@ -0,0 +1,135 @@
+#include <randomlevel/SimulatedServer.hpp>
+
+#include <algorithm>
+
+using namespace randomlevel;
+
+namespace {
+    uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+}
+
+void SimClock::after(double seconds, std::function<void()> callback) {
+    auto generation = m_timerGeneration;
+    this->post(seconds, [this, generation, callback = std::move(callback)]() {
+        if (generation == m_timerGeneration) callback();
+    });
+}
+
+void SimClock::post(double seconds, std::function<void()> callback) {
+    m_events.push({ m_now + std::max(0.0, seconds), m_sequence++, std::move(callback) });
+}
+
+bool SimClock::step() {
+    if (m_events.empty()) return false;
+    auto event = m_events.top();
+    m_events.pop();
+    m_now = event.time;
+    event.callback();
+    return true;
+}
+
+void SimClock::run() {
+    while (this->step()) {}
+}
+
+SimulatedServer::SimulatedServer(SimClock& clock, SimServerConfig config)
+    : m_clock(clock), m_config(config), m_rng(config.seed) {}
+
+bool SimulatedServer::isLive(int levelID) const {
+    if (levelID < 1 || levelID > m_config.maxLevelID) return false;
+    if (levelID == m_config.maxLevelID) return true;
+    auto h = splitmix64(m_config.seed ^ static_cast<uint64_t>(levelID));
+    return static_cast<double>(h >> 11) * 0x1.0p-53 < m_config.liveIDDensity;
+}
+
+void SimulatedServer::fetch(PageRequest const& request, Callback callback) {
+    m_requestCount++;
+
+    double latency = m_config.latency;
+    if (m_config.latencyJitter > 0.0) latency += m_config.latencyJitter * m_rng.uniformReal();
+
+    PageResult result;
+    if (this->throttled() || (m_config.failureRate > 0.0 && m_rng.uniformReal() < m_config.failureRate)) {
+        result.status = FetchStatus::Failed;
+        result.page = request.page;
+    }
+    else {
+        result = this->respond(request);
+        bool singleLookup = request.kind == RequestKind::IdLookup && request.ids.size() == 1;
+        if (m_config.emptyAsFailure && result.count() == 0 && !singleLookup) result.status = FetchStatus::FailedOrEmpty;
+    }
+
+    auto generation = m_generation;
+    m_clock.post(latency, [this, generation, callback = std::move(callback), result = std::move(result)]() {
+        if (generation == m_generation) callback(result);
+    });
+}
+
+std::optional<PageResult> SimulatedServer::lookup(PageRequest const& request) {
+    if (request.kind != RequestKind::FilterPage || request.page >= m_config.storedPages) return std::nullopt;
+    auto result = this->respond(request);
+    if (result.count() == 0) return std::nullopt;
+    return result;
+}
+
+bool SimulatedServer::throttled() {
+    if (m_config.rateLimit <= 0) return false;
+
+    double now = m_clock.now();
+    if (now < m_bannedUntil) return true;
+
+    m_recentRequests.push_back(now);
+    while (!m_recentRequests.empty() && m_recentRequests.front() <= now - m_config.rateWindow) {
+        m_recentRequests.pop_front();
+    }
+    if ((int)m_recentRequests.size() > m_config.rateLimit) {
+        m_banCount++;
+        m_bannedUntil = now + m_config.banDuration;
+        m_recentRequests.clear();
+        return true;
+    }
+    return false;
+}
+
+PageResult SimulatedServer::respond(PageRequest const& request) {
+    PageResult result;
+    result.status = FetchStatus::Ok;
+    result.page = request.page;
+
+    switch (request.kind) {
+    case RequestKind::Recent: {
+        for (int id = m_config.maxLevelID; id > 0 && result.count() < 10; id--) {
+            if (this->isLive(id)) result.levelIDs.push_back(id);
+        }
+        result.total = reportedTotalCap;
+        break;
+    }
+    // Like the real servers, a lookup answers with one page at most.
+    case RequestKind::IdLookup: {
+        for (int id : request.ids) {
+            if (!this->isLive(id)) continue;
+            result.total++;
+            if (result.count() < 10) result.levelIDs.push_back(id);
+        }
+        break;
+    }
+    case RequestKind::FilterPage: {
+        int total = m_config.totalLevels;
+        bool repeats = m_config.page1000Glitch && total >= 10000;
+        int first = request.page * 10;
+        int onPage = repeats ? 10 : std::clamp(total - first, 0, 10);
+        for (int i = 0; i < onPage; i++) {
+            result.levelIDs.push_back(this->levelIDAt((first + i) % std::max(total, 1)));
+        }
+        if (m_config.reportsTotal) result.total = std::min(total, reportedTotalCap);
+        break;
+    }
+    }
+
+    return result;
+}
@@ -0,0 +1,257 @@
+#include <randomlevel/SmartDiscovery.hpp>
+
+#include <algorithm>
+#include <string>
+
+using namespace randomlevel;
+
+SmartDiscovery::SmartDiscovery(Rng& rng, DiscoveryHints hints)
+    : DiscoveryEngine(rng, std::move(hints)) {}
+
+RollStep SmartDiscovery::startDiscovery() {
+    if (m_hints.cachedMaxPage) {
+        int cachedPage = *m_hints.cachedMaxPage;
+        if (cachedPage == 501 || cachedPage >= 1000) {
+            note("Cache is " + std::to_string(cachedPage) + " (Infinite/Max). Verifying Glitch Check...");
+            m_smartPhase = SmartPhase::Phase3_GlitchCheck;
+        }
+        else {
+            note("Cache HIT! Peeking at Page " + std::to_string(cachedPage) + "...");
+            m_foundMaxPage = cachedPage;
+            m_smartPhase = SmartPhase::Phase2_CachePeek;
+        }
+    }
+    else {
+        note("Cache MISS. Starting Fresh Discovery.");
+        m_smartPhase = SmartPhase::Phase1_CheckTotal;
+    }
+
+    return this->request(0.0f);
+}
+
+RollStep SmartDiscovery::onDiscoveryResult(PageResult const& result) {
+    return result.ok() ? this->onPage(result) : this->onFailed(result);
+}
+
+std::string_view SmartDiscovery::discoveryPhaseName() const {
+    switch (m_smartPhase) {
+    case SmartPhase::Phase1_CheckTotal: return "Phase1_CheckTotal";
+    case SmartPhase::Phase2_CachePeek: return "Phase2_CachePeek";
+    case SmartPhase::Phase2b_CacheNext: return "Phase2b_CacheNext";
+    case SmartPhase::Phase2c_CacheBracket: return "Phase2c_CacheBracket";
+    case SmartPhase::Phase3_GlitchCheck: return "Phase3_GlitchCheck";
+    case SmartPhase::Phase4_BinarySearch: return "Phase4_BinarySearch";
+    case SmartPhase::Phase5_CalcExact: return "Phase5_CalcExact";
+    default: return "Idle";
+    }
+}
+
+RollStep SmartDiscovery::request(float delay) {
+    PageRequest req;
+    req.kind = RequestKind::FilterPage;
+
+    switch (m_smartPhase) {
+    case SmartPhase::Phase1_CheckTotal:
+        req.page = 0;
+        note("Phase 1: Checking Page 0...");
+        break;
+    case SmartPhase::Phase2_CachePeek:
+        req.page = m_foundMaxPage;
+        note("Phase 2: Peeking Cache (Page " + std::to_string(m_foundMaxPage) + ")...");
+        break;
+    case SmartPhase::Phase2b_CacheNext:
+        req.page = m_foundMaxPage + 1;
+        note("Phase 2b: Checking Next Page (Page " + std::to_string(req.page) + ")...");
+        break;
+    case SmartPhase::Phase2c_CacheBracket:
+        req.page = m_bracketPage;
+        note("Phase 2c: Bracketing Cache (Page " + std::to_string(m_bracketPage) + ")...");
+        break;
+    case SmartPhase::Phase3_GlitchCheck:
+        req.page = 1000;
+        note("Phase 3: Glitch Check (Page 1000)...");
+        break;
+    case SmartPhase::Phase4_BinarySearch: {
+        int mid = m_searchLow + (m_searchHigh - m_searchLow) / 2;
+        note("Phase 4: Binary Search [" + std::to_string(m_searchLow) + "-" + std::to_string(m_searchHigh) +
+            "] -> Probing " + std::to_string(mid));
+        req.page = mid;
+        break;
+    }
+    case SmartPhase::Phase5_CalcExact:
+        req.page = m_foundMaxPage;
+        note("Phase 5: Calculating exact count on Page " + std::to_string(m_foundMaxPage));
+        break;
+    default:
+        return RollStep::abort("Search was not started.");
+    }
+
+    return RollStep::fetch(std::move(req), delay);
+}
+
+RollStep SmartDiscovery::beginBinarySearch(int low, int high) {
+    m_searchLow = low;
+    m_searchHigh = high;
+    m_smartPhase = SmartPhase::Phase4_BinarySearch;
+    return this->request(searchDelay);
+}
+
+RollStep SmartDiscovery::advanceBinarySearch() {
+    if (m_searchHigh - m_searchLow <= 1) {
+        m_foundMaxPage = m_searchLow;
+        m_smartPhase = SmartPhase::Phase5_CalcExact;
+    }
+    return this->request(searchDelay);
+}
+
+// The peek showed the end is below the cached page (an empty peek) or past
+// the page after it (a full one). One probe a few pages that way brackets a
+// drifted end for a short binary search; a bracket that misses means the
+// cache is stale, and discovery starts over knowing where the end is not.
+// Brackets that would reach page 0 or the glitch page search the old range.
+RollStep SmartDiscovery::bracketCache(int page) {
+    if (page <= 0) return this->beginBinarySearch(0, m_foundMaxPage);
+    if (page >= 1000) return this->beginBinarySearch(m_foundMaxPage + 1, 1000);
+
+    m_bracketPage = page;
+    m_smartPhase = SmartPhase::Phase2c_CacheBracket;
+    return this->request(safeDelay);
+}
+
+RollStep SmartDiscovery::onBracketPage(int count) {
+    bool below = m_bracketPage < m_foundMaxPage;
+    if (count > 0 && count < 10) {
+        note("Bracket page not full. Done.");
+        return this->prepareTarget(m_bracketPage, count);
+    }
+    if (below && count == 10) return this->beginBinarySearch(m_bracketPage, m_foundMaxPage);
+    if (!below && count == 0) return this->beginBinarySearch(m_foundMaxPage + 1, m_bracketPage);
+
+    note("Cache is off by more than " + std::to_string(correctionPages(m_foundMaxPage)) + " pages. Starting Fresh Discovery.");
+    if (below) m_hints.upperPage = std::min(m_hints.upperPage.value_or(m_bracketPage - 1), m_bracketPage - 1);
+    else m_hints.lowerPage = std::max(m_hints.lowerPage, m_bracketPage);
+    m_smartPhase = SmartPhase::Phase1_CheckTotal;
+    return this->request(safeDelay);
+}
+
+RollStep SmartDiscovery::onPage(PageResult const& result) {
+    int count = result.count();
+
+    switch (m_smartPhase) {
+    case SmartPhase::Phase1_CheckTotal: {
+        if (count == 0) return RollStep::abort("No levels found.");
+        int total = result.total;
+        if (total > 0 && total < 9990) {
+            note("Trusted Total: " + std::to_string(total));
+            int maxPage = (total - 1) / 10;
+            int lastPageCount = (total - 1) % 10 + 1;
+            return this->prepareTarget(maxPage, lastPageCount);
+        }
+        if (this->hintedFirstEmpty(1000) < 1000) {
+            note("The filter is known to be finite. Skipping Glitch Check.");
+            return this->beginBinarySearch(this->hintedLowPage(), this->hintedFirstEmpty(1000));
+        }
+        m_smartPhase = SmartPhase::Phase3_GlitchCheck;
+        return this->request(safeDelay);
+    }
+
+    case SmartPhase::Phase2_CachePeek: {
+        if (count < 10 && count > 0) {
+            note("Cache Peek: Page not full. Done.");
+            return this->prepareTarget(m_foundMaxPage, count);
+        }
+        if (count == 10) {
+            m_smartPhase = SmartPhase::Phase2b_CacheNext;
+            return this->request(safeDelay);
+        }
+        note("Cache Peek: Page empty. Searching backwards.");
+        return this->bracketCache(m_foundMaxPage - correctionPages(m_foundMaxPage));
+    }
+
+    case SmartPhase::Phase2b_CacheNext: {
+        if (count == 0) {
+            note("Next page empty. Original cache was end (10 items).");
+            return this->prepareTarget(m_foundMaxPage, 10);
+        }
+        if (count < 10) {
+            note("New levels found (Count " + std::to_string(count) + "). Updated end.");
+            return this->prepareTarget(m_foundMaxPage + 1, count);
+        }
+        if (result.page >= 1000) {
+            note("Hit Page 1000+ via Cache (Infinite). Capping at 501.");
+            return this->prepareTarget(501, 10);
+        }
+        note("Next page full. Expanding search.");
+        return this->bracketCache(m_foundMaxPage + 1 + correctionPages(m_foundMaxPage));
+    }
+
+    case SmartPhase::Phase2c_CacheBracket:
+        return this->onBracketPage(count);
+
+    case SmartPhase::Phase3_GlitchCheck: {
+        if (count > 0) {
+            note("Glitch Detected (Page 1000 has levels). Capping 501.");
+            return this->prepareTarget(501, 10);
+        }
+        note("Finite Mode. Binary Search.");
+        return this->beginBinarySearch(this->hintedLowPage(), this->hintedFirstEmpty(1000));
+    }
+
+    case SmartPhase::Phase4_BinarySearch: {
+        if (count > 0) {
+            if (result.page >= 1000) {
+                note("Binary Search hit 1000+ (Infinite). Capping at 501.");
+                return this->prepareTarget(501, 10);
+            }
+            m_searchLow = result.page;
+        }
+        else {
+            m_searchHigh = result.page;
+        }
+        return this->advanceBinarySearch();
+    }
+
+    case SmartPhase::Phase5_CalcExact: {
+        if (count == 0) {
+            if (m_foundMaxPage > 0) {
+                m_foundMaxPage--;
+                return this->request(safeDelay);
+            }
+            return RollStep::abort("Final page empty.");
+        }
+        return this->prepareTarget(m_foundMaxPage, count);
+    }
+
+    default:
+        return RollStep::abort("Search was not started.");
+    }
+}
+
+RollStep SmartDiscovery::onFailed(PageResult const& result) {
+    if (m_smartPhase == SmartPhase::Phase2_CachePeek) {
+        note("Cache Peek Failed. Searching Backwards.");
+        return this->beginBinarySearch(0, m_foundMaxPage);
+    }
+
+    if (m_smartPhase == SmartPhase::Phase2b_CacheNext) {
+        note("Next page failed. Using Cached Page (10 items).");
+        return this->prepareTarget(m_foundMaxPage, 10);
+    }
+
+    if (m_smartPhase == SmartPhase::Phase2c_CacheBracket) {
+        note("Bracket page failed. Searching without it.");
+        if (m_bracketPage < m_foundMaxPage) return this->beginBinarySearch(0, m_foundMaxPage);
+        return this->beginBinarySearch(m_foundMaxPage + 1, 1000);
+    }
+
+    if (m_smartPhase == SmartPhase::Phase3_GlitchCheck) {
+        return this->beginBinarySearch(0, 1000);
+    }
+
+    if (m_smartPhase == SmartPhase::Phase4_BinarySearch) {
+        m_searchHigh = result.page;
+        return this->advanceBinarySearch();
+    }
+
+    return this->retryOrAbort(this->request(retryDelay));
+}
@@ -0,0 +1,80 @@
+#include <randomlevel/WorkerPool.hpp>
+
+#include <algorithm>
+
+using namespace randomlevel;
+
+WorkerPool::WorkerPool(int threads, size_t queueCapacity) {
+    for (int i = 0; i < std::max(threads, 1); i++) {
+        m_workers.push_back(std::make_unique<Worker>(queueCapacity));
+    }
+    for (auto& worker : m_workers) {
+        worker->thread = std::thread([this, &worker = *worker] { this->work(worker); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    m_stopping = true;
+    for (auto& worker : m_workers) {
+        {
+            std::lock_guard lock(worker->mutex);
+        }
+        worker->wake.notify_one();
+    }
+    for (auto& worker : m_workers) worker->thread.join();
+}
+
+void WorkerPool::submit(Job job, int lane) {
+    auto index = lane >= 0 ? static_cast<size_t>(lane) : m_nextWorker++;
+    auto& worker = *m_workers[index % m_workers.size()];
+    while (!worker.jobs.tryPush(job)) {
+        if (this->drain() == 0) std::this_thread::yield();
+    }
+
+    m_pending++;
+    {
+        std::lock_guard lock(worker.mutex);
+    }
+    worker.wake.notify_one();
+}
+
+int WorkerPool::drain() {
+    int ran = 0;
+    for (auto& worker : m_workers) {
+        while (auto completion = worker->completions.tryPop()) {
+            m_pending--;
+            ran++;
+            if (*completion) (*completion)();
+        }
+    }
+    return ran;
+}
+
+void WorkerPool::waitIdle() {
+    while (m_pending > 0) {
+        if (this->drain() == 0) std::this_thread::yield();
+    }
+}
+
+// The empty lock in submit() and the destructor orders the wake-up after
+// this thread's check, so a notification is never lost between the check
+// and the wait.
+void WorkerPool::work(Worker& worker) {
+    while (true) {
+        auto job = worker.jobs.tryPop();
+        if (!job) {
+            if (m_stopping) return;
+            std::unique_lock lock(worker.mutex);
+            worker.wake.wait(lock, [&] { return !worker.jobs.empty() || m_stopping; });
+            continue;
+        }
+
+        // A completion is always pushed, even an empty one, so pending()
+        // counts down for every job.
+        auto completion = (*job)();
+        while (!worker.completions.tryPush(completion)) {
+            if (m_stopping) break;
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdio>
+
+// Just enough of a test harness for the core: a failed check prints where it
+// failed and the test keeps going, and main returns the failure count.
+namespace randomlevel::test {
+    inline int failures = 0;
+
+    inline void fail(char const* file, int line, char const* expression) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failures++;
+    }
+
+    inline int finish() {
+        if (failures) std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(expression) \
+    do { \
+        if (!(expression)) randomlevel::test::fail(__FILE__, __LINE__, #expression); \
+    } while (0)
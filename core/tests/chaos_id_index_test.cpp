@@ -0,0 +1,80 @@
+#include "Check.hpp"
+
+#include <randomlevel/ChaosIdIndex.hpp>
+
+#include <algorithm>
+
+using namespace randomlevel;
+
+namespace {
+    void checkRecord() {
+        ChaosIdIndex index;
+        std::vector<int> probed = { 10, 20, 30, 40 };
+        std::vector<int> found = { 20 };
+        index.record(probed, found, 35, 0.0);
+
+        CHECK(index.isDead(10) && index.isDead(30));
+        CHECK(index.isLive(20) && !index.isDead(20));
+        // 40 is past the newest ID seen online and may just not exist yet.
+        CHECK(!index.isDead(40) && !index.isLive(40));
+        CHECK(index.pendingChanges() == 3);
+
+        // A deleted level moves from live to dead.
+        std::vector<int> again = { 20 };
+        index.record(again, {}, 35, 1.0);
+        CHECK(index.isDead(20) && !index.isLive(20));
+        CHECK(index.deadCount() == 3 && index.liveCount() == 0);
+    }
+
+    void checkSample() {
+        ChaosIdIndex index;
+        std::vector<int> probed;
+        for (int id = 100; id < 200; id++) {
+            if (id != 150) probed.push_back(id);
+        }
+        index.record(probed, {}, 1000, 0.0);
+
+        Rng rng(3);
+        auto picks = index.sample(rng, 100, 210, 12);
+        CHECK(picks.size() == 12);
+        for (int id : picks) CHECK(!index.isDead(id) && id >= 100 && id <= 210);
+        std::sort(picks.begin(), picks.end());
+        CHECK(std::adjacent_find(picks.begin(), picks.end()) == picks.end());
+
+        // Everything in range is dead: nothing left to sample.
+        CHECK(index.sample(rng, 100, 149, 1).empty());
+    }
+
+    void checkRoundTrip() {
+        ChaosIdIndex index;
+        std::vector<int> probed;
+        for (int id = 1; id < 9000; id += 3) probed.push_back(id);
+        std::vector<int> found = { 1, 4000, 8998 };
+        index.record(probed, found, 100000, 0.0);
+        auto data = index.serialize();
+        CHECK(index.pendingChanges() == 0);
+
+        ChaosIdIndex copy;
+        CHECK(copy.deserialize(data));
+        CHECK(copy.deadCount() == index.deadCount() && copy.liveCount() == 3);
+        CHECK(copy.isDead(7) && copy.isLive(4000) && !copy.isDead(8));
+
+        auto badMagic = data;
+        badMagic[1] ^= 0x20;
+        CHECK(!copy.deserialize(badMagic));
+
+        // A damaged file leaves an empty index rather than half of one.
+        CHECK(copy.deserialize(data));
+        auto truncated = data;
+        truncated.resize(truncated.size() - 5);
+        CHECK(!copy.deserialize(truncated));
+        CHECK(copy.deadCount() == 0 && copy.liveCount() == 0);
+    }
+}
+
+int main() {
+    checkRecord();
+    checkSample();
+    checkRoundTrip();
+    return randomlevel::test::finish();
+}
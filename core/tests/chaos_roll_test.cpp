@@ -0,0 +1,144 @@
+#include "Check.hpp"
+
+#include <randomlevel/ChaosRoll.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include <randomlevel/SimulatedServer.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    struct Rolled {
+        std::optional<RollOutcome> outcome;
+        std::optional<int> maxID;
+        // The level the roll picked, read off the answer it picked from.
+        int levelID = 0;
+        bool live = false;
+        std::vector<std::vector<int>> probes;
+        int requests = 0;
+    };
+
+    SimServerConfig sparseServer() {
+        SimServerConfig config;
+        config.maxLevelID = 5000;
+        config.liveIDDensity = 0.3;
+        return config;
+    }
+
+    Rolled roll(SimServerConfig config, int knownMaxID, int batchSize, uint64_t seed = 1, ChaosIdIndex const* index = nullptr) {
+        config.seed = seed;
+        SimClock clock;
+        SimulatedServer server(clock, config);
+        RollDriver driver(server, clock);
+
+        Rolled rolled;
+        PageResult last;
+        Rng rng(seed);
+        ChaosRoll engine(rng, knownMaxID, batchSize);
+        engine.setIdIndex(index);
+        engine.setHooks({
+            .maxIDFound = [&](int id) { rolled.maxID = id; },
+            .probeAnswered = [&](std::vector<int> const& probed, PageResult const& result) {
+                rolled.probes.push_back(probed);
+                last = result;
+            },
+        });
+        driver.run(engine, [&](RollOutcome const& o) { rolled.outcome = o; });
+        clock.run();
+
+        if (rolled.outcome && rolled.outcome->success) rolled.levelID = last.levelIDs.at(rolled.outcome->slot);
+        rolled.live = server.isLive(rolled.levelID);
+        rolled.requests = server.requestCount();
+        return rolled;
+    }
+
+    void checkFindsNewest() {
+        auto config = sparseServer();
+        auto rolled = roll(config, 0, 1);
+        CHECK(rolled.maxID == config.maxLevelID);
+        CHECK(rolled.outcome && rolled.outcome->success);
+        CHECK(rolled.outcome && rolled.outcome->stats.requestsByPhase.count("Chaos_FetchLatest") == 1);
+
+        // A known newest ID skips the Recent lookup.
+        auto known = roll(config, config.maxLevelID, 1);
+        CHECK(!known.maxID);
+        CHECK(known.outcome && known.outcome->stats.requestsByPhase.count("Chaos_FetchLatest") == 0);
+    }
+
+    void checkPicksLiveLevels() {
+        auto config = sparseServer();
+        config.failureRate = 0.2;
+
+        for (uint64_t seed = 1; seed <= 50; seed++) {
+            auto rolled = roll(config, 4000, 1, seed);
+            CHECK(rolled.outcome && rolled.outcome->success);
+            CHECK(rolled.live);
+            CHECK(rolled.levelID >= ChaosRoll::minLevelID && rolled.levelID <= 4000);
+            for (auto const& probe : rolled.probes) {
+                CHECK(probe.size() == 1 && probe[0] >= ChaosRoll::minLevelID && probe[0] <= 4000);
+            }
+        }
+    }
+
+    // A batch asks for several distinct IDs at once and picks among the
+    // live ones, so a sparse range takes fewer requests.
+    void checkBatches() {
+        auto config = sparseServer();
+        config.liveIDDensity = 0.05;
+        int single = 0;
+        int batched = 0;
+        for (uint64_t seed = 1; seed <= 40; seed++) {
+            single += roll(config, 4000, 1, seed).requests;
+
+            auto rolled = roll(config, 4000, 5, seed);
+            batched += rolled.requests;
+            CHECK(rolled.outcome && rolled.outcome->success && rolled.live);
+            for (auto probe : rolled.probes) {
+                CHECK(probe.size() == 5);
+                std::sort(probe.begin(), probe.end());
+                CHECK(std::adjacent_find(probe.begin(), probe.end()) == probe.end());
+            }
+        }
+        CHECK(batched * 2 < single);
+
+        // Batches stop at one page of answers.
+        auto capped = roll(config, 4000, 50, 1);
+        for (auto const& probe : capped.probes) CHECK((int)probe.size() == ChaosRoll::maxBatchSize);
+    }
+
+    // Probes skip IDs the index knows are dead, until nothing else is left.
+    void checkIdIndex() {
+        auto config = sparseServer();
+        ChaosIdIndex index;
+        std::vector<int> dead;
+        for (int id = ChaosRoll::minLevelID; id <= 3900; id++) dead.push_back(id);
+        index.record(dead, {}, 4000, 0.0);
+
+        for (uint64_t seed = 1; seed <= 20; seed++) {
+            auto rolled = roll(config, 4000, 3, seed, &index);
+            CHECK(rolled.outcome && rolled.outcome->success && rolled.live);
+            for (auto const& probe : rolled.probes) {
+                for (int id : probe) CHECK(id > 3900 && id <= 4000);
+            }
+        }
+
+        // A range the index says is all dead is probed anyway.
+        ChaosIdIndex stale;
+        std::vector<int> everything;
+        for (int id = ChaosRoll::minLevelID; id <= 4000; id++) everything.push_back(id);
+        stale.record(everything, {}, 4000, 0.0);
+        auto rolled = roll(config, 4000, 3, 1, &stale);
+        CHECK(rolled.outcome && rolled.outcome->success);
+    }
+}
+
+int main() {
+    checkFindsNewest();
+    checkPicksLiveLevels();
+    checkBatches();
+    checkIdIndex();
+    return randomlevel::test::finish();
+}
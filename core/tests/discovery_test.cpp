@@ -0,0 +1,177 @@
+#include "Check.hpp"
+
+#include <randomlevel/DiscoveryEngine.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include <randomlevel/SimulatedServer.hpp>
+
+#include <optional>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    // Max page reported for result sets that repeat past page 1000.
+    constexpr int infinitePage = 501;
+
+    struct Rolled {
+        std::optional<RollOutcome> outcome;
+        std::optional<int> maxPage;
+        int invalidations = 0;
+        int requests = 0;
+    };
+
+    Rolled roll(SimServerConfig config, DiscoveryStrategy strategy, DiscoveryHints hints = {}, uint64_t seed = 1, int width = 3) {
+        config.seed = seed;
+        SimClock clock;
+        SimulatedServer server(clock, config);
+        RollDriver driver(server, clock);
+
+        Rolled rolled;
+        Rng rng(seed);
+        auto engine = makeDiscovery(strategy, rng, hints, width);
+        engine->setHooks({
+            .maxPageFound = [&](int page) { rolled.maxPage = page; },
+            .cacheInvalidated = [&]() { rolled.invalidations++; },
+        });
+        driver.run(*engine, [&](RollOutcome const& o) { rolled.outcome = o; });
+        clock.run();
+        rolled.requests = server.requestCount();
+        return rolled;
+    }
+
+    SimServerConfig serverWith(int totalLevels, bool reportsTotal) {
+        SimServerConfig config;
+        config.totalLevels = totalLevels;
+        config.reportsTotal = reportsTotal;
+        return config;
+    }
+
+    // The strategy finds the exact last page and picks a level that exists,
+    // with and without a reported total, and caps repeating sets.
+    void checkFindsEnd(DiscoveryStrategy strategy) {
+        for (int total : { 1, 10, 11, 95, 2345, 9990, 9999 }) {
+            for (bool reportsTotal : { true, false }) {
+                auto rolled = roll(serverWith(total, reportsTotal), strategy);
+                CHECK(rolled.outcome && rolled.outcome->success);
+                CHECK(rolled.maxPage == (total - 1) / 10);
+                if (rolled.outcome) CHECK(rolled.outcome->page * 10 + rolled.outcome->slot < total);
+            }
+        }
+
+        auto glitched = roll(serverWith(50000, false), strategy);
+        CHECK(glitched.outcome && glitched.outcome->success);
+        CHECK(glitched.maxPage == infinitePage);
+        if (glitched.outcome) CHECK(glitched.outcome->page <= infinitePage);
+    }
+
+    // A correct cached page costs fewer requests than a cold roll, and a
+    // stale one still ends on the right page.
+    void checkCache(DiscoveryStrategy strategy) {
+        auto config = serverWith(2345, false);
+        auto cold = roll(config, strategy);
+        auto warm = roll(config, strategy, { .cachedMaxPage = 234 });
+        CHECK(warm.outcome && warm.outcome->success && warm.maxPage == 234);
+        CHECK(warm.requests < cold.requests);
+
+        for (int cached : { 231, 240, 40, 900 }) {
+            auto stale = roll(config, strategy, { .cachedMaxPage = cached });
+            CHECK(stale.outcome && stale.outcome->success && stale.maxPage == 234);
+        }
+    }
+
+    // Every level of a small set can come up.
+    void checkUniform(DiscoveryStrategy strategy) {
+        constexpr int total = 25;
+        std::vector<int> hits(total);
+        for (uint64_t seed = 1; seed <= 400; seed++) {
+            auto rolled = roll(serverWith(total, false), strategy, {}, seed);
+            if (!rolled.outcome || !rolled.outcome->success) continue;
+            hits[rolled.outcome->page * 10 + rolled.outcome->slot]++;
+        }
+        for (int count : hits) CHECK(count > 0);
+    }
+
+    void checkBisect() {
+        checkFindsEnd(DiscoveryStrategy::Bisect);
+        checkCache(DiscoveryStrategy::Bisect);
+        checkUniform(DiscoveryStrategy::Bisect);
+    }
+
+    void checkGallop() {
+        checkFindsEnd(DiscoveryStrategy::Gallop);
+        checkCache(DiscoveryStrategy::Gallop);
+        checkUniform(DiscoveryStrategy::Gallop);
+
+        // A cached page a little off, within the correction window, is
+        // corrected by galloping from it in either direction.
+        auto config = serverWith(2345, false);
+        auto cold = roll(config, DiscoveryStrategy::Gallop);
+        for (int cached : { 231, 238 }) {
+            auto near = roll(config, DiscoveryStrategy::Gallop, { .cachedMaxPage = cached });
+            CHECK(near.maxPage == 234 && near.invalidations == 0);
+            CHECK(near.requests < cold.requests);
+        }
+    }
+
+    void checkParallel() {
+        checkFindsEnd(DiscoveryStrategy::Parallel);
+        checkCache(DiscoveryStrategy::Parallel);
+        checkUniform(DiscoveryStrategy::Parallel);
+
+        // Every width finds the end; wider rounds spend requests to save
+        // round trips, so a cold roll takes less time than a bisection.
+        auto config = serverWith(2345, false);
+        auto bisect = roll(config, DiscoveryStrategy::Bisect);
+        for (int width : { 1, 2, 3, 8 }) {
+            auto rolled = roll(config, DiscoveryStrategy::Parallel, {}, 1, width);
+            CHECK(rolled.outcome && rolled.maxPage == 234);
+            if (width >= 3 && rolled.outcome && bisect.outcome) {
+                CHECK(rolled.outcome->stats.elapsed() < bisect.outcome->stats.elapsed());
+            }
+        }
+    }
+}
+
+namespace {
+    // With nearly every level seen, redraws run out; the picks still fill
+    // the playlist from the unseen levels on pages the roll fetched.
+    void checkSeenPicks() {
+        constexpr int total = 30;
+        auto config = serverWith(total, false);
+        SimClock idClock;
+        SimulatedServer ids(idClock, config);
+        SeenLevels seen;
+        for (int index = 3; index < total - 3; index++) seen.insert(ids.levelIDAt(index), 0.0);
+
+        for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop, DiscoveryStrategy::Parallel }) {
+            for (uint64_t seed = 1; seed <= 20; seed++) {
+                config.seed = seed;
+                SimClock clock;
+                SimulatedServer server(clock, config);
+                RollDriver driver(server, clock);
+                Rng rng(seed);
+                auto engine = makeDiscovery(strategy, rng, {});
+                engine->setSeenLevels(&seen);
+                engine->setPickCount(5);
+                std::optional<RollOutcome> outcome;
+                driver.run(*engine, [&](RollOutcome const& o) { outcome = o; });
+                clock.run();
+
+                CHECK(outcome && outcome->success && outcome->picks.size() == 5);
+                if (!outcome) continue;
+                for (auto pick : outcome->picks) {
+                    int index = pick.page * 10 + pick.slot;
+                    CHECK(index < 3 || index >= total - 3);
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    checkBisect();
+    checkGallop();
+    checkParallel();
+    checkSeenPicks();
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,157 @@
+#include "Check.hpp"
+
+#include <randomlevel/FilterCountCache.hpp>
+
+#include <string>
+
+using namespace randomlevel;
+
+namespace {
+    FilterKey keyFor(int difficulty, uint16_t flags = 0) {
+        auto list = std::to_string(difficulty);
+        return FilterKey::from({ .difficulty = list, .flags = flags });
+    }
+
+    FilterCountEntry entryAt(int maxPage, double now) {
+        return { .maxPage = maxPage, .updatedAt = now, .observedSince = now };
+    }
+
+    void checkEviction() {
+        FilterCountCache cache(3);
+        for (int d = 1; d <= 3; d++) cache.store(keyFor(d), entryAt(d * 10, d));
+        CHECK(cache.size() == 3);
+
+        // Looking a key up makes it the most recently used, so the next
+        // store evicts the one after it.
+        CHECK(cache.find(keyFor(1)));
+        cache.store(keyFor(4), entryAt(40, 4.0));
+        CHECK(cache.size() == 3);
+        CHECK(cache.find(keyFor(1)) && !cache.find(keyFor(2)));
+        CHECK(cache.find(keyFor(3)) && cache.find(keyFor(4)));
+
+        // Storing an existing key replaces it in place.
+        cache.store(keyFor(3), entryAt(33, 5.0));
+        CHECK(cache.size() == 3 && cache.find(keyFor(3))->maxPage == 33);
+
+        cache.setCapacity(1);
+        CHECK(cache.size() == 1 && cache.find(keyFor(3)));
+        cache.erase(keyFor(3), 6.0);
+        CHECK(cache.size() == 0);
+    }
+
+    void checkWriteBehind() {
+        FilterCountCache cache;
+        CHECK(!cache.needsFlush(0.0, 30.0, 8));
+        cache.store(keyFor(1), entryAt(5, 100.0));
+        CHECK(!cache.needsFlush(110.0, 30.0, 8));
+        CHECK(cache.needsFlush(130.0, 30.0, 8));
+        for (int d = 2; d <= 8; d++) cache.store(keyFor(d), entryAt(5, 101.0));
+        CHECK(cache.needsFlush(101.0, 30.0, 8));
+        cache.serialize();
+        CHECK(cache.pendingChanges() == 0 && !cache.needsFlush(500.0, 30.0, 8));
+    }
+
+    constexpr double day = 86400.0;
+
+    void checkGrowth() {
+        // Ten pages a day. The fit starts from a zero rate worth a day of
+        // history, so it gets there over a few observations.
+        FilterCountEntry entry = entryAt(100, 0.0);
+        entry = entry.observe(110, day);
+        entry = entry.observe(120, 2 * day);
+        CHECK(entry.pagesPerDay == 7.5f);
+        CHECK(entry.predictedPage(2 * day) == 120);
+        CHECK(entry.predictedPage(4 * day) == 135);
+        for (int d = 3; d <= 8; d++) entry = entry.observe(100 + 10 * d, d * day);
+        CHECK(entry.pagesPerDay > 9.0f && entry.pagesPerDay < 10.0f);
+        // Extrapolation stops after 30 days.
+        CHECK(entry.predictedPage(100 * day) == entry.predictedPage(38 * day));
+
+        // A shrinking count fits a negative rate but never predicts below 0.
+        FilterCountEntry shrinking = entryAt(5, 0.0).observe(0, day);
+        CHECK(shrinking.pagesPerDay < 0.0f);
+        CHECK(shrinking.predictedPage(30 * day) == 0);
+
+        // The infinite marker resets the fit and is never extrapolated.
+        auto infinite = entry.observe(501, 3 * day);
+        CHECK(infinite.pagesPerDay == 0.0f && infinite.observedSince == 3 * day);
+        CHECK(infinite.predictedPage(10 * day) == 501);
+        CHECK(entryAt(500, 0.0).observe(500, day).predictedPage(day) == 500);
+
+        FilterCountCache cache;
+        auto key = keyFor(2);
+        cache.observe(key, 40, 0.0);
+        cache.observe(key, 50, day);
+        CHECK(cache.find(key)->pagesPerDay > 0.0f);
+        CHECK(cache.find(key)->observedSince == 0.0);
+    }
+
+    void checkBounds() {
+        auto any = FilterKey::from({});
+        auto hard = FilterKey::from({ .difficulty = "4" });
+        auto starredHard = FilterKey::from({ .difficulty = "4", .flags = StarFilter });
+        auto coinsHard = FilterKey::from({ .difficulty = "4", .flags = CoinsFilter });
+
+        FilterCountCache cache;
+        cache.store(any, entryAt(400, 100.0));
+        cache.store(starredHard, entryAt(20, 100.0));
+        cache.store(coinsHard, entryAt(35, 100.0));
+
+        // The broader key caps, the narrower ones set a floor.
+        auto bounds = cache.bounds(hard, 110.0, 60.0);
+        CHECK(bounds.lowerPage == 35 && bounds.upperPage == 400 && !bounds.infinite);
+
+        // Stale entries are ignored.
+        cache.store(any, entryAt(400, 0.0));
+        bounds = cache.bounds(hard, 110.0, 60.0);
+        CHECK(bounds.lowerPage == 35 && !bounds.upperPage);
+
+        // A narrower key past the page 1000 glitch makes this one infinite.
+        cache.store(starredHard, entryAt(501, 100.0));
+        CHECK(cache.bounds(hard, 110.0, 60.0).infinite);
+
+        // A floor above the cap is a contradiction and says nothing.
+        cache.store(any, entryAt(10, 100.0));
+        bounds = cache.bounds(hard, 110.0, 60.0);
+        CHECK(bounds.lowerPage == 0 && !bounds.upperPage && !bounds.infinite);
+    }
+
+    void checkRoundTrip() {
+        FilterCountCache cache(4);
+        cache.store(keyFor(1), entryAt(12, 1.0));
+        cache.store(keyFor(1, CoinsFilter), entryAt(3, 2.0));
+        cache.store(keyFor(1, OriginalFilter | TwoPlayerFilter), entryAt(7, 3.0));
+        auto data = cache.serialize();
+
+        FilterCountCache copy(4);
+        CHECK(copy.deserialize(data));
+        CHECK(copy.size() == 3);
+        CHECK(copy.find(keyFor(1))->maxPage == 12);
+        CHECK(copy.find(keyFor(1, CoinsFilter))->maxPage == 3);
+        CHECK(copy.find(keyFor(1, OriginalFilter | TwoPlayerFilter))->maxPage == 7);
+
+        // The LRU order survives: the oldest entry goes first.
+        FilterCountCache small(2);
+        CHECK(small.deserialize(data));
+        CHECK(small.size() == 2 && !small.find(keyFor(1)));
+
+        // Files from before the key had every search flag are dropped whole.
+        auto old = data;
+        old[4] = 3;
+        CHECK(!copy.deserialize(old));
+
+        auto truncated = data;
+        truncated.resize(truncated.size() - 3);
+        CHECK(!copy.deserialize(truncated));
+        CHECK(copy.size() == 2);
+    }
+}
+
+int main() {
+    checkEviction();
+    checkWriteBehind();
+    checkGrowth();
+    checkBounds();
+    checkRoundTrip();
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,78 @@
+#include "Check.hpp"
+
+#include <randomlevel/FilterKey.hpp>
+
+using namespace randomlevel;
+
+namespace {
+    void checkLists() {
+        CHECK(parseFilterList("-", 3) == 0);
+        CHECK(parseFilterList("", 3) == 0);
+        CHECK(parseFilterList("1,2,5", 0) == (1u << 1 | 1u << 2 | 1u << 5));
+        // Difficulty values start at -3 (auto), hence the offset.
+        CHECK(parseFilterList("-3,-2,-1", 3) == (1u << 0 | 1u << 1 | 1u << 2));
+        CHECK(parseFilterList("40", 0) == 0);
+    }
+
+    void checkKeys() {
+        auto key = FilterKey::from({ .difficulty = "1,2", .length = "3", .demonFilter = 0, .flags = StarFilter });
+        CHECK(key.difficultyMask == (1u << 4 | 1u << 5));
+        CHECK(key.lengthMask == 1u << 3);
+        CHECK(key.flags == StarFilter);
+        CHECK(key.queryHash == 0);
+
+        // Field order in the list does not change the key.
+        auto same = FilterKey::from({ .difficulty = "2,1", .length = "3", .flags = StarFilter });
+        CHECK(key == same);
+        CHECK(key.hash() == same.hash());
+
+        auto query = FilterKey::from({ .query = "bloodbath" });
+        CHECK(query.queryHash == hashBytes("bloodbath"));
+        CHECK(query != FilterKey::from({ .query = "Bloodbath" }));
+        CHECK(query.hash() != FilterKey {}.hash());
+    }
+
+    // Every filter the search form sends has to tell keys apart.
+    void checkFlagsSeparateKeys() {
+        auto plain = FilterKey::from({ .difficulty = "3" });
+        for (uint16_t flag : { OriginalFilter, TwoPlayerFilter, CoinsFilter }) {
+            auto flagged = FilterKey::from({ .difficulty = "3", .flags = flag });
+            CHECK(flagged != plain);
+            CHECK(flagged.hash() != plain.hash());
+        }
+    }
+
+    void checkNarrows() {
+        auto any = FilterKey::from({ .difficulty = "-", .length = "-" });
+        auto hard = FilterKey::from({ .difficulty = "4", .length = "-" });
+        auto hardOrHarder = FilterKey::from({ .difficulty = "4,5", .length = "-" });
+        auto starredHard = FilterKey::from({ .difficulty = "4", .flags = StarFilter });
+        auto epic = FilterKey::from({ .flags = EpicFilter });
+        auto featured = FilterKey::from({ .flags = FeaturedFilter });
+
+        CHECK(hard.narrows(any));
+        CHECK(hard.narrows(hardOrHarder));
+        CHECK(!hardOrHarder.narrows(hard));
+        CHECK(starredHard.narrows(hard));
+        CHECK(!hard.narrows(starredHard));
+        CHECK(!any.narrows(hard));
+        CHECK(!epic.narrows(featured));
+        CHECK(epic.narrows(any));
+
+        // Original, two-player and coins only ever remove levels.
+        auto original = FilterKey::from({ .difficulty = "4", .flags = OriginalFilter });
+        auto originalCoins = FilterKey::from({ .difficulty = "4", .flags = OriginalFilter | CoinsFilter });
+        CHECK(original.narrows(hard));
+        CHECK(originalCoins.narrows(original));
+        CHECK(!original.narrows(originalCoins));
+        CHECK(!original.narrows(FilterKey::from({ .difficulty = "4", .flags = TwoPlayerFilter })));
+    }
+}
+
+int main() {
+    checkLists();
+    checkKeys();
+    checkFlagsSeparateKeys();
+    checkNarrows();
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,80 @@
+#include "Check.hpp"
+
+#include <randomlevel/IdBitmap.hpp>
+#include <randomlevel/Random.hpp>
+
+#include <algorithm>
+#include <set>
+
+using namespace randomlevel;
+
+namespace {
+    uint64_t naiveRank(std::set<uint32_t> const& ids, uint32_t id) {
+        return std::distance(ids.begin(), ids.upper_bound(id));
+    }
+
+    uint32_t naiveSelectAbsent(std::set<uint32_t> const& ids, uint32_t min, uint32_t k) {
+        for (uint32_t id = min;; id++) {
+            if (!ids.contains(id) && k-- == 0) return id;
+        }
+    }
+
+    // Sparse blocks stay arrays; the first block grows past the array limit
+    // and turns into a bitmap.
+    void checkAgainstSet() {
+        Rng rng(7);
+        IdBitmap bitmap;
+        std::set<uint32_t> ids;
+        for (int i = 0; i < 6000; i++) {
+            auto id = (uint32_t)rng.uniformInt(0, 20000);
+            CHECK(bitmap.add(id) == ids.insert(id).second);
+        }
+        for (int i = 0; i < 300; i++) {
+            auto id = (uint32_t)rng.uniformInt(100000, 400000);
+            CHECK(bitmap.add(id) == ids.insert(id).second);
+        }
+        for (int i = 0; i < 500; i++) {
+            auto id = (uint32_t)rng.uniformInt(0, 20000);
+            CHECK(bitmap.remove(id) == (ids.erase(id) == 1));
+        }
+        CHECK(bitmap.size() == ids.size());
+
+        for (uint32_t id : { 0u, 1u, 4095u, 4096u, 20000u, 65535u, 65536u, 150000u, 400000u, 4000000u }) {
+            CHECK(bitmap.contains(id) == ids.contains(id));
+            CHECK(bitmap.rank(id) == naiveRank(ids, id));
+        }
+        for (uint32_t min : { 0u, 5000u, 19990u, 65530u }) {
+            for (uint64_t k : { 0ull, 1ull, 17ull, 999ull }) {
+                CHECK(bitmap.selectAbsent(min, 1000000, k) == naiveSelectAbsent(ids, min, (uint32_t)k));
+            }
+        }
+    }
+
+    void checkRoundTrip() {
+        IdBitmap bitmap;
+        for (uint32_t id = 0; id < 10000; id += 2) bitmap.add(id);
+        for (uint32_t id = 70000; id < 70100; id += 7) bitmap.add(id);
+
+        ByteWriter out;
+        bitmap.write(out);
+        auto data = out.take();
+
+        IdBitmap copy;
+        ByteReader in(data);
+        CHECK(copy.read(in));
+        CHECK(copy.size() == bitmap.size());
+        CHECK(copy.contains(9998) && !copy.contains(9999) && copy.contains(70007));
+        CHECK(copy.rank(70100) == bitmap.rank(70100));
+
+        data.resize(data.size() / 2);
+        IdBitmap truncated;
+        ByteReader cut(data);
+        CHECK(!truncated.read(cut));
+    }
+}
+
+int main() {
+    checkAgainstSet();
+    checkRoundTrip();
+    return randomlevel::test::finish();
+}
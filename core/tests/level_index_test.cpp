@@ -0,0 +1,238 @@
+#include "Check.hpp"
+
+#include <randomlevel/LevelIndex.hpp>
+#include <randomlevel/LocalIndexRoll.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include <randomlevel/SimulatedServer.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    std::filesystem::path const indexPath = std::filesystem::temp_directory_path() / "randomlevel_index_test.bin";
+
+    bool writeFile(std::filesystem::path const& path, std::vector<uint8_t> const& data) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const*>(data.data()), (std::streamsize)data.size());
+        return (bool)out;
+    }
+
+    std::vector<IndexedLevel> randomLevels(int count) {
+        Rng rng(9);
+        std::vector<IndexedLevel> levels;
+        for (int i = 0; i < count; i++) {
+            IndexedLevel level;
+            level.levelID = 128 + i * 3;
+            level.difficulty = (int8_t)rng.uniformInt(-3, 5);
+            if (level.difficulty == 0) level.difficulty = -1;
+            if (level.difficulty == -2) level.demon = (uint8_t)rng.uniformInt(1, 5);
+            level.length = (uint8_t)rng.uniformInt(0, 5);
+            if (rng.uniformInt(0, 2) == 0) level.flags |= StarFilter;
+            if (rng.uniformInt(0, 4) == 0) level.flags |= FeaturedFilter;
+            if (rng.uniformInt(0, 9) == 0) level.flags |= EpicFilter;
+            if (rng.uniformInt(0, 4) == 0) level.customSong = rng.uniformInt(500, 503);
+            else level.audioTrack = rng.uniformInt(0, 5);
+            levels.push_back(level);
+        }
+        return levels;
+    }
+
+    std::vector<FilterKey> keys() {
+        return {
+            FilterKey::from({}),
+            FilterKey::from({ .difficulty = "1,2" }),
+            FilterKey::from({ .difficulty = "-2", .demonFilter = 3 }),
+            FilterKey::from({ .difficulty = "-3,5", .length = "3,4" }),
+            FilterKey::from({ .flags = StarFilter }),
+            FilterKey::from({ .length = "0", .flags = NoStarFilter }),
+            FilterKey::from({ .flags = FeaturedFilter | EpicFilter }),
+            FilterKey::from({ .songID = 3 }),
+            FilterKey::from({ .songID = 501, .flags = CustomSongFilter }),
+        };
+    }
+
+    uint64_t naiveCount(std::vector<IndexedLevel> const& levels, FilterKey const& key) {
+        return std::count_if(levels.begin(), levels.end(), [&](auto const& level) { return level.matches(key); });
+    }
+
+    bool agrees(LevelIndex const& index, std::vector<IndexedLevel> const& levels) {
+        if (index.size() != levels.size()) return false;
+        for (auto const& key : keys()) {
+            if (index.count(key) != naiveCount(levels, key)) return false;
+        }
+        return true;
+    }
+
+    void checkQueries() {
+        auto levels = randomLevels(1000);
+        CHECK(writeFile(indexPath, LevelIndex::build(levels)));
+        LevelIndex index;
+        CHECK(index.open(indexPath));
+        CHECK(agrees(index, levels));
+
+        Rng rng(4);
+        for (auto const& key : keys()) {
+            auto id = index.pick(key, rng);
+            CHECK(id.has_value() == (naiveCount(levels, key) > 0));
+            if (!id) continue;
+            auto level = std::find_if(levels.begin(), levels.end(), [&](auto const& l) { return l.levelID == *id; });
+            CHECK(level != levels.end() && level->matches(key));
+        }
+        CHECK(!index.pick(FilterKey::from({ .songID = 9999, .flags = CustomSongFilter }), rng));
+
+        CHECK(LevelIndex::canAnswer(FilterKey::from({ .difficulty = "4", .flags = StarFilter })));
+        CHECK(!LevelIndex::canAnswer(FilterKey::from({ .flags = UncompletedFilter })));
+        CHECK(!LevelIndex::canAnswer(FilterKey::from({ .flags = CoinsFilter })));
+        CHECK(!LevelIndex::canAnswer(FilterKey::from({ .query = "bloodbath" })));
+    }
+
+    // The overlay shadows updated rows and hides removed ones, and
+    // serialize() folds it into a file that reads back the same.
+    void checkOverlay() {
+        auto levels = randomLevels(300);
+        CHECK(writeFile(indexPath, LevelIndex::build(levels)));
+        LevelIndex index;
+        CHECK(index.open(indexPath));
+
+        auto changed = levels[10];
+        changed.difficulty = 5;
+        changed.flags = StarFilter | EpicFilter;
+        index.update(changed);
+        levels[10] = changed;
+
+        IndexedLevel added;
+        added.levelID = 5000000;
+        added.difficulty = 2;
+        index.update(added);
+        levels.push_back(added);
+
+        index.remove(levels[20].levelID);
+        index.remove(999999);
+        levels.erase(levels.begin() + 20);
+
+        // Updating a level to what it already is changes nothing.
+        index.update(levels[30]);
+        CHECK(index.pendingChanges() == 3);
+        CHECK(agrees(index, levels));
+
+        auto changes = index.changes();
+        CHECK(changes.updated.size() == 2);
+        CHECK(std::count(changes.removed.begin(), changes.removed.end(), 999999) == 1);
+
+        auto merged = index.serialize();
+        index.close();
+        CHECK(writeFile(indexPath, merged));
+        CHECK(index.open(indexPath));
+        CHECK(index.pendingChanges() == 0);
+        CHECK(agrees(index, levels));
+
+        // The same changes carried onto a rebuild of the original file.
+        auto rebuilt = randomLevels(300);
+        CHECK(writeFile(indexPath, LevelIndex::build(rebuilt)));
+        CHECK(index.open(indexPath));
+        index.apply(changes);
+        CHECK(agrees(index, levels));
+        index.close();
+    }
+
+    void checkDump() {
+        auto levels = parseLevelDump(
+            "id,difficulty,demon,demon_difficulty,length,stars,featured,epic,song,custom_song\r\n"
+            "128,30,0,0,2,3,1,0,4,0\r\n"
+            "129,50,1,6,4,10,0,2,0,501\n"
+            "\n"
+            "0,10,0,0,0,0,0,0,0,0\n");
+        CHECK(levels && levels->size() == 2);
+        if (!levels || levels->size() != 2) return;
+        auto const& normal = (*levels)[0];
+        CHECK(normal.levelID == 128 && normal.difficulty == 3 && normal.length == 2 && normal.audioTrack == 4);
+        CHECK(normal.flags == (StarFilter | FeaturedFilter));
+        auto const& demon = (*levels)[1];
+        CHECK(demon.difficulty == -2 && demon.demon == 5 && demon.customSong == 501);
+        CHECK(demon.flags == (StarFilter | LegendaryFilter));
+
+        CHECK(!parseLevelDump("name,difficulty\nStereo Madness,10\n"));
+    }
+
+    // Hands every answer on and keeps the last one, which the roll's
+    // outcome refers to.
+    class RecordingFetcher : public PageFetcher {
+    public:
+        explicit RecordingFetcher(PageFetcher& inner) : m_inner(inner) {}
+
+        PageResult last;
+
+        void fetch(PageRequest const& request, Callback callback) override {
+            m_inner.fetch(request, [this, callback = std::move(callback)](PageResult result) {
+                last = result;
+                callback(std::move(result));
+            });
+        }
+
+    private:
+        PageFetcher& m_inner;
+    };
+
+    // Picks come from the index and each costs one ID lookup; levels the
+    // server no longer has are reported and skipped.
+    void checkLocalRoll() {
+        auto levels = randomLevels(400);
+        CHECK(writeFile(indexPath, LevelIndex::build(levels)));
+        LevelIndex index;
+        CHECK(index.open(indexPath));
+        auto key = FilterKey::from({ .flags = StarFilter });
+
+        int successes = 0;
+        for (uint64_t seed = 1; seed <= 20; seed++) {
+            SimServerConfig config;
+            config.liveIDDensity = 0.6;
+            config.seed = seed;
+            SimClock clock;
+            SimulatedServer server(clock, config);
+            RecordingFetcher fetcher(server);
+            RollDriver driver(fetcher, clock);
+
+            Rng rng(seed);
+            LocalIndexRoll roll(rng, index, key);
+            std::vector<int> missing;
+            roll.setHooks({ .levelsMissing = [&](std::vector<int> const& ids) { missing = ids; } });
+            std::optional<RollOutcome> outcome;
+            driver.run(roll, [&](RollOutcome const& o) { outcome = o; });
+            clock.run();
+
+            for (int id : missing) CHECK(!server.isLive(id));
+            CHECK(outcome && outcome->stats.requests == (int)missing.size() + outcome->success);
+            if (!outcome || !outcome->success) continue;
+            successes++;
+            int id = fetcher.last.levelIDs.at(0);
+            CHECK(server.isLive(id));
+            auto level = std::find_if(levels.begin(), levels.end(), [&](auto const& l) { return l.levelID == id; });
+            CHECK(level != levels.end() && level->matches(key));
+        }
+        CHECK(successes >= 18);
+
+        Rng rng(1);
+        LocalIndexRoll none(rng, index, FilterKey::from({ .songID = 9999, .flags = CustomSongFilter }));
+        SimClock clock;
+        SimulatedServer server(clock, {});
+        RollDriver driver(server, clock);
+        std::optional<RollOutcome> outcome;
+        driver.run(none, [&](RollOutcome const& o) { outcome = o; });
+        clock.run();
+        CHECK(outcome && !outcome->success && server.requestCount() == 0);
+        index.close();
+    }
+}
+
+int main() {
+    checkQueries();
+    checkOverlay();
+    checkDump();
+    checkLocalRoll();
+    std::filesystem::remove(indexPath);
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,66 @@
+#include "Check.hpp"
+
+#include <randomlevel/LevelResponse.hpp>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr std::string_view response =
+        "1:128:2:1st level:6:16:10:9001:14:42:9:30:15:2:18:3:42:1|"
+        "1:129:2:Second:6:17:10:5:14:-3:17:1:43:6:35:501"
+        "#16:RobTop:71|17:Player17:900"
+        "#songs"
+        "#2:10:10"
+        "#hash";
+
+    void checkParse() {
+        auto page = parseLevelPage(response);
+        CHECK(page.has_value());
+        if (!page) return;
+
+        CHECK(page->total == 2 && page->offset == 10 && page->amount == 10);
+        CHECK(page->levels.size() == 2);
+        CHECK(page->levels[0].levelID == 128 && page->levels[0].downloads == 9001 && page->levels[0].likes == 42);
+        CHECK(page->levels[1].likes == -3);
+        CHECK(page->levels[0].name.in(response) == "1st level");
+        CHECK(page->levels[1].raw.in(response).starts_with("1:129:"));
+
+        auto creator = page->creator(page->levels[0].playerID);
+        CHECK(creator && creator->name.in(response) == "RobTop" && creator->accountID == 71);
+        CHECK(!page->creator(99));
+
+        auto fields = parseLevelFields(page->levels[1].raw.in(response));
+        CHECK(fields && fields->demon && fields->demonDifficulty == 6 && fields->customSong == 501);
+        CHECK(levelIntField(page->levels[0].raw.in(response), "15") == 2);
+        CHECK(!levelField(page->levels[0].raw.in(response), "99"));
+    }
+
+    void checkScanAgrees() {
+        auto scan = scanLevelPage(response);
+        CHECK(scan && scan->count == 2 && scan->total == 2);
+        if (!scan) return;
+        CHECK(scan->record(1).starts_with("1:129:"));
+        CHECK(scan->record(2).empty());
+
+        int records = 0;
+        scan->forEachRecord([&](std::string_view entry) { records += entry.starts_with("1:12"); });
+        CHECK(records == 2);
+    }
+
+    void checkRejects() {
+        auto empty = parseLevelPage("-1");
+        CHECK(empty && empty->levels.empty());
+
+        CHECK(!parseLevelPage(""));
+        CHECK(!parseLevelPage("error code: 1015"));
+        // A level without an ID makes the whole page unreadable.
+        CHECK(!parseLevelPage("2:No ID:6:16##songs#1:0:10#hash"));
+    }
+}
+
+int main() {
+    checkParse();
+    checkScanAgrees();
+    checkRejects();
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,58 @@
+#include "Check.hpp"
+
+#include <randomlevel/MaxIdEstimator.hpp>
+
+#include <cmath>
+
+using namespace randomlevel;
+
+namespace {
+    constexpr double day = 86400.0;
+
+    void checkFit() {
+        MaxIdEstimator estimator;
+        CHECK(!estimator.predict(0.0));
+
+        // 20000 uploads a day, seen once a day for a week.
+        for (int i = 0; i < 7; i++) CHECK(estimator.observe(1000000 + 20000 * i, i * day));
+        CHECK(std::abs(estimator.uploadRate() * day - 20000.0) < 1.0);
+        CHECK(std::abs(*estimator.predict(8 * day) - (1000000 + 20000 * 8)) <= 1);
+
+        // Older IDs never count; a newer one within minSpacing is merged.
+        CHECK(!estimator.observe(1000000, 7 * day));
+        CHECK(estimator.observe(1120001, 6 * day + 60.0));
+        CHECK(estimator.history().size() == 7);
+        CHECK(estimator.history().back().maxID == 1120001);
+    }
+
+    void checkLeadCap() {
+        MaxIdEstimator estimator;
+        estimator.observe(1000000, 0.0);
+        estimator.observe(1500000, day);
+        // Half a million a day would run far ahead after a month.
+        CHECK(*estimator.predict(30 * day) == 1500000 + MaxIdEstimator::maxLead);
+        CHECK(*estimator.predict(day) == 1500000);
+    }
+
+    void checkRestore() {
+        MaxIdEstimator estimator;
+        estimator.restore({ { 2 * day, 300 }, { 0.0, 100 }, { day, 200 }, { NAN, 999 }, { 3 * day, 0 } });
+        CHECK(estimator.history().size() == 3);
+        CHECK(estimator.history().front().maxID == 100);
+        CHECK(std::abs(estimator.uploadRate() * day - 100.0) < 1e-6);
+
+        // Under minSpacing of history there is no rate yet.
+        MaxIdEstimator fresh;
+        fresh.observe(100, 0.0);
+        fresh.observe(200, 10.0);
+        CHECK(fresh.uploadRate() == 0.0);
+        CHECK(*fresh.predict(day) == 200);
+    }
+}
+
+int main() {
+    checkFit();
+    checkLeadCap();
+    checkRestore();
+    return randomlevel::test::finish();
+}
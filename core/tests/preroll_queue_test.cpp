@@ -0,0 +1,61 @@
+#include "Check.hpp"
+
+#include <randomlevel/PrerollQueue.hpp>
+
+#include <string>
+
+using namespace randomlevel;
+
+namespace {
+    void checkFifo() {
+        PrerollQueue<int> queue(2, 60.0);
+        queue.setKey("easy");
+        CHECK(queue.wantsMore(0.0));
+        queue.push(1, 0.0);
+        queue.push(2, 1.0);
+        queue.push(3, 2.0);
+        CHECK(queue.size() == 2 && !queue.wantsMore(2.0));
+
+        // Only the current key is served.
+        CHECK(!queue.pop("hard", 3.0));
+        CHECK(queue.pop("easy", 3.0) == 1);
+        CHECK(queue.pop("easy", 3.0) == 2);
+        CHECK(!queue.pop("easy", 3.0));
+    }
+
+    void checkKeyChange() {
+        PrerollQueue<int> queue(3, 60.0);
+        queue.setKey("easy");
+        queue.push(1, 0.0);
+        queue.setKey("easy");
+        CHECK(queue.size() == 1);
+        queue.setKey("hard");
+        CHECK(queue.size() == 0 && queue.key() == "hard");
+    }
+
+    void checkExpiry() {
+        PrerollQueue<int> queue(3, 10.0);
+        queue.setKey("easy");
+        queue.push(1, 0.0);
+        queue.push(2, 5.0);
+        CHECK(queue.pop("easy", 12.0) == 2);
+
+        queue.push(3, 20.0);
+        CHECK(queue.wantsMore(20.0) && queue.size() == 1);
+        CHECK(queue.wantsMore(31.0) && queue.size() == 0);
+
+        // Shrinking drops the oldest entries.
+        queue.push(4, 40.0);
+        queue.push(5, 41.0);
+        queue.push(6, 42.0);
+        queue.configure(1, 10.0);
+        CHECK(queue.size() == 1 && queue.pop("easy", 42.0) == 6);
+    }
+}
+
+int main() {
+    checkFifo();
+    checkKeyChange();
+    checkExpiry();
+    return randomlevel::test::finish();
+}
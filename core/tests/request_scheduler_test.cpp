@@ -0,0 +1,98 @@
+#include "Check.hpp"
+
+#include <randomlevel/RequestScheduler.hpp>
+
+#include <cmath>
+
+using namespace randomlevel;
+
+namespace {
+    bool near(double a, double b) {
+        return std::abs(a - b) < 1e-9;
+    }
+
+    void checkBucket() {
+        SchedulerConfig config;
+        config.burst = 3.0;
+        RequestScheduler scheduler(config);
+
+        // The burst goes out at once, then requests wait for the refill.
+        for (int i = 0; i < 3; i++) CHECK(scheduler.reserve(1.0) == 0.0);
+        CHECK(near(scheduler.reserve(1.0), 1.0));
+        CHECK(near(scheduler.reserve(1.0), 2.0));
+        // Waiting pays the debt back.
+        CHECK(scheduler.reserve(4.0) == 0.0);
+    }
+
+    void checkIncrease() {
+        RequestScheduler scheduler;
+        auto const& config = scheduler.config();
+        scheduler.onSuccess(1.0, 0.2);
+        CHECK(near(scheduler.rate(), config.initialRate + config.additiveIncrease));
+
+        for (int i = 0; i < 100; i++) scheduler.onSuccess(1.0, 0.2);
+        CHECK(scheduler.rate() == config.maxRate);
+
+        // A slow answer is a gentle cut, not a failure.
+        scheduler.onSuccess(1.0, config.latencyTarget + 1.0);
+        CHECK(near(scheduler.rate(), config.maxRate * config.slowDecrease));
+        CHECK(scheduler.pausedUntil() == 0.0);
+    }
+
+    void checkDecrease() {
+        RequestScheduler scheduler;
+        auto const& config = scheduler.config();
+
+        scheduler.onFailure(10.0);
+        CHECK(near(scheduler.rate(), config.initialRate * config.multiplicativeDecrease));
+        CHECK(near(scheduler.pausedUntil(), 10.0 + config.baseCooldown));
+        CHECK(near(scheduler.reserve(10.0), config.baseCooldown));
+
+        // Each failure in a row doubles the cooldown, up to maxCooldown,
+        // and the rate never drops below minRate.
+        scheduler.onFailure(10.0);
+        CHECK(near(scheduler.pausedUntil(), 10.0 + 2 * config.baseCooldown));
+        for (int i = 0; i < 20; i++) scheduler.onFailure(10.0);
+        CHECK(scheduler.rate() == config.minRate);
+        CHECK(near(scheduler.pausedUntil(), 10.0 + config.maxCooldown));
+
+        // A success resets the streak.
+        scheduler.onSuccess(100.0, 0.2);
+        scheduler.onFailure(100.0);
+        CHECK(near(scheduler.pausedUntil(), 100.0 + config.baseCooldown));
+    }
+
+    void checkSaveRestore() {
+        RequestScheduler scheduler;
+        for (int i = 0; i < 4; i++) scheduler.onSuccess(1.0, 0.2);
+        scheduler.reserve(1.0);
+        scheduler.onFailure(2.0);
+        auto state = scheduler.save(2.0);
+
+        RequestScheduler copy;
+        copy.restore(state, 2.0);
+        CHECK(copy.rate() == scheduler.rate());
+        CHECK(copy.pausedUntil() == scheduler.pausedUntil());
+
+        // A pause that ran out while saved is dropped.
+        RequestScheduler later;
+        later.restore(state, 100.0);
+        CHECK(later.pausedUntil() == 0.0);
+        CHECK(later.reserve(100.0) == 0.0);
+
+        // States from the future or without a rate are ignored.
+        RequestScheduler ignored;
+        ignored.restore(state, 1.0);
+        CHECK(ignored.rate() == ignored.config().initialRate);
+        ignored.restore({}, 5.0);
+        CHECK(ignored.rate() == ignored.config().initialRate);
+    }
+}
+
+int main() {
+    checkBucket();
+    checkIncrease();
+    checkDecrease();
+    checkSaveRestore();
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,152 @@
+#include "Check.hpp"
+
+#include <randomlevel/CoroutineRoll.hpp>
+#include <randomlevel/DiscoveryEngine.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include <randomlevel/SimulatedServer.hpp>
+
+#include <deque>
+
+using namespace randomlevel;
+
+namespace {
+    // Answers each request with the next scripted result after a fixed
+    // latency, and lets the test look at the scheduler between answers.
+    class ScriptedFetcher : public PageFetcher {
+    public:
+        ScriptedFetcher(SimClock& clock, std::deque<PageResult> script) : m_clock(clock), m_script(std::move(script)) {}
+
+        std::function<void(PageResult const&)> onAnswer;
+
+        void fetch(PageRequest const& request, Callback callback) override {
+            auto result = m_script.front();
+            m_script.pop_front();
+            result.page = request.page;
+            m_clock.post(0.1, [this, callback = std::move(callback), result] {
+                callback(result);
+                if (onAnswer) onAnswer(result);
+            });
+        }
+
+    private:
+        SimClock& m_clock;
+        std::deque<PageResult> m_script;
+    };
+
+    // Fetches pages 0, 1, ... until one has levels.
+    class UntilLevels : public CoroutineRoll {
+    protected:
+        RollTask run() override {
+            this->setPhase("Test");
+            for (int page = 0;; page++) {
+                PageRequest request;
+                request.page = page;
+                auto result = co_await this->fetch(request, 0.0f);
+                if (result.count() > 0) co_return RollStep::done(page, 0);
+            }
+        }
+    };
+
+    PageResult answer(FetchStatus status, int levels = 0) {
+        PageResult result;
+        result.status = status;
+        for (int i = 0; i < levels; i++) result.levelIDs.push_back(1000 + i);
+        return result;
+    }
+
+    void checkMaybeEmptyKeepsPace() {
+        SimClock clock;
+        ScriptedFetcher fetcher(clock, {
+            answer(FetchStatus::FailedOrEmpty),
+            answer(FetchStatus::FailedOrEmpty),
+            answer(FetchStatus::Ok, 10),
+        });
+        RequestScheduler scheduler;
+        RollDriver driver(fetcher, clock);
+        driver.setScheduler(&scheduler);
+
+        double startRate = scheduler.rate();
+        std::vector<double> rates;
+        std::vector<double> pauses;
+        fetcher.onAnswer = [&](PageResult const&) {
+            rates.push_back(scheduler.rate());
+            pauses.push_back(scheduler.pausedUntil() - clock.now());
+        };
+
+        UntilLevels roll;
+        std::optional<RollOutcome> outcome;
+        driver.run(roll, [&](RollOutcome const& o) { outcome = o; });
+        clock.run();
+
+        CHECK(outcome && outcome->success && outcome->page == 2);
+        CHECK(rates.size() == 3);
+        for (double rate : rates) CHECK(rate >= startRate);
+        for (double pause : pauses) CHECK(pause <= 0.0);
+    }
+
+    void checkFailureBacksOff() {
+        SimClock clock;
+        ScriptedFetcher fetcher(clock, {
+            answer(FetchStatus::Failed),
+            answer(FetchStatus::Ok, 10),
+        });
+        RequestScheduler scheduler;
+        RollDriver driver(fetcher, clock);
+        driver.setScheduler(&scheduler);
+
+        double startRate = scheduler.rate();
+        std::optional<double> rate;
+        std::optional<double> pause;
+        fetcher.onAnswer = [&](PageResult const& result) {
+            if (result.ok()) return;
+            rate = scheduler.rate();
+            pause = scheduler.pausedUntil() - clock.now();
+        };
+
+        UntilLevels roll;
+        driver.run(roll, [](RollOutcome const&) {});
+        clock.run();
+
+        CHECK(rate && *rate < startRate);
+        CHECK(pause && *pause > 0.0);
+    }
+
+    double coldTime(SimServerConfig config, DiscoveryStrategy strategy, bool scheduled) {
+        SimClock clock;
+        SimulatedServer server(clock, config);
+        RollDriver driver(server, clock);
+        RequestScheduler scheduler;
+        if (scheduled) driver.setScheduler(&scheduler);
+
+        Rng rng(42);
+        auto engine = makeDiscovery(strategy, rng, {});
+        std::optional<RollOutcome> outcome;
+        driver.run(*engine, [&](RollOutcome const& o) { outcome = o; });
+        clock.run();
+
+        CHECK(outcome && outcome->success);
+        return outcome ? outcome->stats.elapsed() : 0.0;
+    }
+
+    // On the game backend every probe past the last page is FailedOrEmpty.
+    // Pacing must not make a first roll there slower than the fixed delays.
+    void checkGamePathColdTime() {
+        SimServerConfig config;
+        config.totalLevels = 2345;
+        config.reportsTotal = false;
+        config.emptyAsFailure = true;
+        for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop, DiscoveryStrategy::Parallel }) {
+            for (uint64_t seed : { 1, 2, 3 }) {
+                config.seed = seed;
+                CHECK(coldTime(config, strategy, true) <= coldTime(config, strategy, false));
+            }
+        }
+    }
+}
+
+int main() {
+    checkMaybeEmptyKeepsPace();
+    checkFailureBacksOff();
+    checkGamePathColdTime();
+    return randomlevel::test::finish();
+}
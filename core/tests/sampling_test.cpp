@@ -0,0 +1,45 @@
+#include "Check.hpp"
+
+#include <randomlevel/Sampling.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    void checkDistinct() {
+        Rng rng(11);
+        for (int count : { 1, 5, 10 }) {
+            auto values = sampleDistinct(rng, 128, 140, count);
+            CHECK((int)values.size() == count);
+            for (int value : values) CHECK(value >= 128 && value <= 140);
+            std::sort(values.begin(), values.end());
+            CHECK(std::adjacent_find(values.begin(), values.end()) == values.end());
+        }
+
+        // A range smaller than the count is returned whole.
+        auto all = sampleDistinct(rng, 3, 6, 10);
+        std::sort(all.begin(), all.end());
+        CHECK(all == std::vector<int>({ 3, 4, 5, 6 }));
+        CHECK(sampleDistinct(rng, 7, 7, 3) == std::vector<int>({ 7 }));
+    }
+
+    // Every value of a range comes up about as often.
+    void checkUniform() {
+        Rng rng(5);
+        std::vector<int> hits(20);
+        constexpr int draws = 4000;
+        for (int i = 0; i < draws; i++) {
+            for (int value : sampleDistinct(rng, 0, 19, 3)) hits[value]++;
+        }
+        // Each value is expected 600 times.
+        for (int count : hits) CHECK(count > 480 && count < 720);
+    }
+}
+
+int main() {
+    checkDistinct();
+    checkUniform();
+    return randomlevel::test::finish();
+}
@@ -0,0 +1,73 @@
+#include "Check.hpp"
+
+#include <randomlevel/SeenLevels.hpp>
+
+using namespace randomlevel;
+
+namespace {
+    int falsePositives(SeenLevels const& seen, int from, int count) {
+        int hits = 0;
+        for (int id = from; id < from + count; id++) hits += seen.contains(id);
+        return hits;
+    }
+
+    void checkRotation() {
+        SeenLevels seen(1000);
+        for (int id = 1; id <= 1000; id++) seen.insert(id, 0.0);
+        for (int id = 1; id <= 1000; id++) CHECK(seen.contains(id));
+
+        // The second batch fills a new generation; the first is still there
+        // as the previous one.
+        for (int id = 1001; id <= 2000; id++) seen.insert(id, 0.0);
+        for (int id = 1; id <= 2000; id += 37) CHECK(seen.contains(id));
+
+        // The third rotates the first batch out, except what the exact ring
+        // or a false positive still holds.
+        for (int id = 2001; id <= 3000; id++) seen.insert(id, 0.0);
+        for (int id = 1001; id <= 3000; id += 37) CHECK(seen.contains(id));
+        CHECK(falsePositives(seen, 1, 1000) < 30);
+        CHECK(falsePositives(seen, 1000000, 10000) < 300);
+    }
+
+    void checkRing() {
+        // The ring keeps the newest IDs exactly even when the filters
+        // are smaller than it.
+        SeenLevels seen(100);
+        for (int id = 1000; id < 1350; id++) seen.insert(id, 0.0);
+        for (int id = 1350 - (int)SeenLevels::recentCapacity; id < 1350; id++) CHECK(seen.contains(id));
+
+        SeenLevels none(0);
+        none.insert(5, 0.0);
+        CHECK(!none.contains(5));
+        CHECK(none.pendingChanges() == 0);
+    }
+
+    void checkRoundTrip() {
+        SeenLevels seen(500);
+        for (int id = 10; id < 900; id++) seen.insert(id, 5.0);
+        CHECK(seen.needsFlush(5.0, 60.0, 100));
+        auto data = seen.serialize();
+        CHECK(seen.pendingChanges() == 0);
+
+        SeenLevels copy(1);
+        CHECK(copy.deserialize(data));
+        CHECK(copy.capacity() == 500);
+        for (int id = 10; id < 900; id += 11) CHECK(copy.contains(id) == seen.contains(id));
+
+        auto badVersion = data;
+        badVersion[4] ^= 0x7f;
+        CHECK(!copy.deserialize(badVersion));
+
+        auto truncated = data;
+        truncated.resize(truncated.size() - 9);
+        CHECK(!copy.deserialize(truncated));
+        CHECK(!copy.contains(899));
+    }
+}
+
+int main() {
+    checkRotation();
+    checkRing();
+    checkRoundTrip();
+    return randomlevel::test::finish();
+}
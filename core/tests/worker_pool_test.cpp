@@ -0,0 +1,124 @@
+#include "Check.hpp"
+
+#include <randomlevel/SpscQueue.hpp>
+#include <randomlevel/WorkerPool.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    void checkQueue() {
+        SpscQueue<int> queue(3);
+        CHECK(queue.capacity() == 4);
+        CHECK(queue.empty() && !queue.tryPop());
+
+        for (int i = 0; i < 4; i++) CHECK(queue.tryPush(i));
+        int extra = 99;
+        CHECK(!queue.tryPush(extra));
+        CHECK(extra == 99);
+
+        // FIFO, and the ring wraps around.
+        CHECK(queue.tryPop() == 0 && queue.tryPop() == 1);
+        int more[] = { 4, 5 };
+        CHECK(queue.tryPush(more[0]) && queue.tryPush(more[1]));
+        for (int expected = 2; expected <= 5; expected++) CHECK(queue.tryPop() == expected);
+        CHECK(queue.empty());
+    }
+
+    // One thread pushes a long run through a small ring while another pops
+    // it; every value arrives once, in order.
+    void checkQueueThreads() {
+        constexpr int count = 200000;
+        SpscQueue<int> queue(16);
+        std::thread producer([&] {
+            for (int i = 0; i < count; i++) {
+                int value = i;
+                while (!queue.tryPush(value)) std::this_thread::yield();
+            }
+        });
+
+        bool ordered = true;
+        for (int expected = 0; expected < count;) {
+            auto value = queue.tryPop();
+            if (!value) {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered &= *value == expected;
+            expected++;
+        }
+        producer.join();
+        CHECK(ordered);
+        CHECK(queue.empty());
+    }
+
+    void checkPool() {
+        WorkerPool pool(3, 4);
+        CHECK(pool.threadCount() == 3);
+
+        // Completions run on the owning thread, and only from drain() or
+        // waitIdle().
+        auto owner = std::this_thread::get_id();
+        std::atomic<int> ran = 0;
+        int completed = 0;
+        bool onOwner = true;
+        for (int i = 0; i < 50; i++) {
+            pool.submit([&] {
+                ran++;
+                return [&] {
+                    completed++;
+                    onOwner &= std::this_thread::get_id() == owner;
+                };
+            });
+        }
+        pool.waitIdle();
+        CHECK(ran == 50 && completed == 50 && onOwner);
+        CHECK(pool.pending() == 0 && pool.drain() == 0);
+    }
+
+    // Jobs on one lane run in submission order even while other lanes run.
+    void checkLanes() {
+        WorkerPool pool(4, 2);
+        std::vector<int> order[2];
+        for (int i = 0; i < 40; i++) {
+            int lane = i % 2;
+            pool.submit([&order, lane, i] {
+                order[lane].push_back(i);
+                return WorkerPool::Completion();
+            }, lane);
+        }
+        pool.waitIdle();
+        for (auto const& lane : order) {
+            CHECK(lane.size() == 20);
+            for (size_t i = 1; i < lane.size(); i++) CHECK(lane[i] == lane[i - 1] + 2);
+        }
+    }
+
+    // Destruction finishes queued jobs but drops their completions.
+    void checkShutdown() {
+        std::atomic<int> ran = 0;
+        int completed = 0;
+        {
+            WorkerPool pool(1, 8);
+            for (int i = 0; i < 5; i++) {
+                pool.submit([&] {
+                    ran++;
+                    return [&] { completed++; };
+                });
+            }
+        }
+        CHECK(ran == 5 && completed == 0);
+    }
+}
+
+int main() {
+    checkQueue();
+    checkQueueThreads();
+    checkPool();
+    checkLanes();
+    checkShutdown();
+    return randomlevel::test::finish();
+}
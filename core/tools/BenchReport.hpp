@@ -0,0 +1,48 @@
+#pragma once
+
+// Result table shared by the benchmark tools.
+
+#include <randomlevel/DiscoveryEngine.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace randomlevel::bench {
+    struct Summary {
+        int rolls = 0;
+        int failures = 0;
+        int bans = 0;
+        int coldRequests = 0;
+        double coldTime = 0.0;
+        double meanRequests = 0.0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+    };
+
+    inline char const* strategyName(DiscoveryStrategy strategy) {
+        switch (strategy) {
+        case DiscoveryStrategy::Bisect: return "bisect";
+        case DiscoveryStrategy::Parallel: return "par3";
+        default: return "gallop";
+        }
+    }
+
+    inline double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        auto index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        return values[std::min(index, values.size() - 1)];
+    }
+
+    inline void printHeader() {
+        std::printf("%-44s %6s %5s %5s %9s %9s %9s %9s %9s\n",
+            "scenario", "rolls", "fail", "bans", "cold req", "cold s", "req/roll", "p50 s", "p99 s");
+    }
+
+    inline void printRow(std::string const& name, Summary const& s) {
+        std::printf("%-44s %6d %5d %5d %9d %9.2f %9.2f %9.2f %9.2f\n",
+            name.c_str(), s.rolls, s.failures, s.bans, s.coldRequests, s.coldTime, s.meanRequests, s.p50, s.p99);
+    }
+}
@@ -0,0 +1,49 @@
+// libFuzzer target for the response scanner: the vector and scalar byte
+// scans must agree, and scanLevelPage must find the same page as
+// parseLevelPage whenever the latter accepts the input.
+
+#include <randomlevel/ByteScan.hpp>
+#include <randomlevel/LevelResponse.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    void check(bool condition) {
+        if (!condition) std::abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const* data, size_t size) {
+    std::string_view text(reinterpret_cast<char const*>(data), size);
+
+    for (char byte : { '#', '|', ':', '~', size ? text.front() : '\0' }) {
+        check(countByte(text, byte) == countByteScalar(text, byte));
+        for (size_t from : { size_t(0), size_t(1), size / 3, size, size + 1 }) {
+            check(findByte(text, byte, from) == findByteScalar(text, byte, from));
+        }
+    }
+
+    auto scan = scanLevelPage(text);
+    auto page = parseLevelPage(text);
+    if (!page) return 0;
+
+    check(scan.has_value());
+    check(scan->count == (int)page->levels.size());
+    check(scan->total == page->total && scan->offset == page->offset && scan->amount == page->amount);
+
+    std::vector<std::string_view> records;
+    scan->forEachRecord([&](std::string_view entry) { records.push_back(entry); });
+    check((int)records.size() == scan->count);
+    for (int i = 0; i < scan->count; i++) {
+        check(records[i] == page->levels[i].raw.in(text));
+        check(scan->record(i) == records[i]);
+        check(levelField(records[i], "1").has_value());
+    }
+    check(scan->record(scan->count).empty());
+    return 0;
+}
@@ -0,0 +1,473 @@
+// Local stand-in for boomlings.com's getGJLevels21.php, for pointing the
+// mod's Server URL setting at while testing request pacing. It serves a
+// synthetic level corpus and imitates the real server's rate limit bans,
+// latency and page-1000 repeat. POSIX only.
+
+#include <randomlevel/FilterKey.hpp>
+#include <randomlevel/LevelIndex.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace randomlevel;
+
+namespace {
+    struct Options {
+        int port = 8573;
+        int levels = 200000;
+        double liveDensity = 0.6;
+        double rated = 0.08;
+        double featured = 0.4;
+        double epic = 0.05;
+        double demon = 0.05;
+        double customSong = 0.7;
+        int songs = 500;
+        int rateLimit = 60;
+        double rateWindow = 30.0;
+        double banDuration = 120.0;
+        double latency = 0.25;
+        double jitter = 0.05;
+        double failureRate = 0.0;
+        bool pageGlitch = true;
+        bool quiet = false;
+        uint64_t seed = 1;
+    };
+
+    // Same as the reported total cap in SimulatedServer.
+    constexpr int reportedTotalCap = 9999;
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            auto arg = argv[i];
+            auto flag = [&](char const* name) { return !std::strcmp(arg, name); };
+            if (flag("--quiet")) {
+                options.quiet = true;
+                continue;
+            }
+            if (flag("--no-glitch")) {
+                options.pageGlitch = false;
+                continue;
+            }
+            if (i + 1 >= argc) break;
+            auto value = argv[++i];
+            if (flag("--port")) options.port = std::atoi(value);
+            else if (flag("--levels")) options.levels = std::atoi(value);
+            else if (flag("--live-density")) options.liveDensity = std::atof(value);
+            else if (flag("--rated")) options.rated = std::atof(value);
+            else if (flag("--featured")) options.featured = std::atof(value);
+            else if (flag("--epic")) options.epic = std::atof(value);
+            else if (flag("--demon")) options.demon = std::atof(value);
+            else if (flag("--custom-song")) options.customSong = std::atof(value);
+            else if (flag("--songs")) options.songs = std::max(1, std::atoi(value));
+            else if (flag("--rate-limit")) options.rateLimit = std::atoi(value);
+            else if (flag("--rate-window")) options.rateWindow = std::atof(value);
+            else if (flag("--ban")) options.banDuration = std::atof(value);
+            else if (flag("--latency")) options.latency = std::atof(value);
+            else if (flag("--jitter")) options.jitter = std::atof(value);
+            else if (flag("--failure-rate")) options.failureRate = std::atof(value);
+            else if (flag("--seed")) options.seed = std::strtoull(value, nullptr, 10);
+        }
+        return options;
+    }
+
+    uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // Deterministic draws per level ID or request number, so a run only
+    // depends on the options and the order requests arrive in.
+    class Draws {
+    public:
+        Draws(uint64_t seed, int stream) : m_state(splitmix64(seed ^ ((uint64_t)stream << 20))) {}
+
+        double real() { return (double)(this->next() >> 11) * 0x1.0p-53; }
+        int below(int bound) { return (int)(this->next() % (uint64_t)bound); }
+
+    private:
+        uint64_t next() { return m_state = splitmix64(m_state); }
+
+        uint64_t m_state;
+    };
+
+    struct MockLevel {
+        IndexedLevel indexed;
+        int playerID = 0;
+        std::string entry;
+    };
+
+    // A level entry in the server's "key:value" format, with the fields
+    // parseLevelFields reads plus a few the game expects to be present.
+    // flags supplies the original, two-player and coins fields.
+    std::string levelEntry(LevelFields const& fields, uint16_t flags, int playerID, int downloads, int likes) {
+        auto field = [](int key, auto value) { return std::to_string(key) + ":" + std::to_string(value) + ":"; };
+        std::string entry = field(1, fields.levelID) + "2:Level " + std::to_string(fields.levelID) + ":";
+        entry += field(5, 1) + field(6, playerID) + "8:10:" + field(9, fields.difficulty);
+        entry += field(10, downloads) + field(12, fields.audioTrack) + "13:22:" + field(14, likes);
+        entry += field(17, fields.demon ? 1 : 0) + field(43, fields.demonDifficulty) + field(25, fields.autoLevel ? 1 : 0);
+        entry += field(18, fields.stars) + field(19, fields.featureScore) + field(42, fields.epic);
+        entry += field(15, fields.length) + field(35, fields.customSong);
+        entry += field(30, (flags & OriginalFilter) ? 0 : 128) + field(31, (flags & TwoPlayerFilter) ? 1 : 0);
+        entry += field(37, (flags & CoinsFilter) ? 2 : 0) + field(38, (flags & CoinsFilter) ? 1 : 0);
+        entry.pop_back();
+        return entry;
+    }
+
+    std::vector<MockLevel> buildCorpus(Options const& options) {
+        static constexpr int lengthWeights[] = { 25, 25, 20, 15, 12, 3 };
+        static constexpr int demonCodes[] = { 3, 4, 0, 5, 6 };
+
+        std::vector<MockLevel> corpus;
+        corpus.reserve(options.levels);
+        for (int id = 128; (int)corpus.size() < options.levels; id++) {
+            Draws draws(options.seed, id);
+            if (draws.real() >= options.liveDensity) continue;
+
+            LevelFields fields;
+            fields.levelID = id;
+            int roll = draws.below(100);
+            for (int length = 0; length < 6; roll -= lengthWeights[length++]) {
+                if (roll < lengthWeights[length]) {
+                    fields.length = length;
+                    break;
+                }
+            }
+
+            if (draws.real() < options.demon) {
+                fields.demon = true;
+                fields.difficulty = 50;
+                fields.demonDifficulty = demonCodes[draws.below(5)];
+            }
+            else if (draws.real() < 0.03) {
+                fields.autoLevel = true;
+                fields.difficulty = 50;
+            }
+            else {
+                fields.difficulty = draws.below(6) * 10;
+            }
+
+            bool rated = draws.real() < options.rated;
+            if (rated) {
+                fields.stars = fields.autoLevel ? 1 : fields.demon ? 10 : std::max(2, fields.difficulty / 10 + 1);
+                if (fields.difficulty == 0 && !fields.demon) fields.difficulty = 10;
+                if (draws.real() < options.featured) fields.featureScore = 1 + draws.below(5000);
+                if (draws.real() < options.epic) fields.epic = 1 + (draws.real() < 0.3) + (draws.real() < 0.1);
+            }
+
+            if (draws.real() < options.customSong) fields.customSong = 500000 + draws.below(options.songs);
+            else fields.audioTrack = draws.below(22);
+
+            auto playerID = 1000 + draws.below(200000);
+            auto downloads = draws.below(rated ? 2000000 : 5000);
+            auto likes = draws.below(std::max(1, downloads / 20));
+            // LevelFields has no room for these, so they go straight into the
+            // indexed level the searches match against.
+            auto indexed = IndexedLevel::from(fields);
+            if (draws.real() >= 0.1) indexed.flags |= OriginalFilter;
+            if (draws.real() < 0.05) indexed.flags |= TwoPlayerFilter;
+            if (rated && draws.real() < 0.3) indexed.flags |= CoinsFilter;
+            corpus.push_back({ indexed, playerID, levelEntry(fields, indexed.flags, playerID, downloads, likes) });
+        }
+        // Newest first, like the server's default order.
+        std::reverse(corpus.begin(), corpus.end());
+        return corpus;
+    }
+
+    std::string formDecode(std::string_view text) {
+        std::string out;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '+') out += ' ';
+            else if (text[i] == '%' && i + 2 < text.size()) {
+                out += (char)std::strtol(std::string(text.substr(i + 1, 2)).c_str(), nullptr, 16);
+                i += 2;
+            }
+            else out += text[i];
+        }
+        return out;
+    }
+
+    std::map<std::string, std::string, std::less<>> parseForm(std::string_view body) {
+        std::map<std::string, std::string, std::less<>> form;
+        while (!body.empty()) {
+            auto end = body.find('&');
+            auto pair = body.substr(0, end);
+            body = end == std::string_view::npos ? std::string_view() : body.substr(end + 1);
+            auto equals = pair.find('=');
+            if (equals == std::string_view::npos) continue;
+            form[formDecode(pair.substr(0, equals))] = formDecode(pair.substr(equals + 1));
+        }
+        return form;
+    }
+
+    struct Reply {
+        int status = 200;
+        std::string body;
+        std::string note;
+        double delay = 0.0;
+    };
+
+    class MockServer {
+    public:
+        explicit MockServer(Options options)
+            : m_options(options), m_corpus(buildCorpus(options)), m_started(std::chrono::steady_clock::now()) {
+            for (size_t i = 0; i < m_corpus.size(); i++) m_byID[m_corpus[i].indexed.levelID] = i;
+        }
+
+        std::vector<MockLevel> const& corpus() const { return m_corpus; }
+
+        Reply handle(std::string_view body) {
+            std::lock_guard lock(m_mutex);
+            m_requests++;
+            Draws draws(m_options.seed ^ 0x5eed, m_requests);
+            auto reply = this->respond(parseForm(body), draws);
+            reply.delay = m_options.latency + m_options.jitter * draws.real();
+            return reply;
+        }
+
+    private:
+        Reply respond(std::map<std::string, std::string, std::less<>> const& form, Draws& draws) {
+            auto value = [&](std::string_view key) -> std::string {
+                auto it = form.find(key);
+                return it == form.end() ? std::string() : it->second;
+            };
+
+            if (this->throttled()) return { 429, "error code: 1015", "banned" };
+            if (draws.real() < m_options.failureRate) return { 500, "", "failed" };
+
+            auto query = value("str");
+            int page = std::max(0, std::atoi(value("page").c_str()));
+            if (!query.empty() && query.find_first_not_of("0123456789,") == std::string::npos) {
+                return this->lookupIDs(query);
+            }
+            return this->search(this->filterFrom(value, query), query, page);
+        }
+
+        double now() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_started).count();
+        }
+
+        bool throttled() {
+            if (m_options.rateLimit <= 0) return false;
+
+            double now = this->now();
+            if (now < m_bannedUntil) return true;
+
+            m_recent.push_back(now);
+            while (!m_recent.empty() && m_recent.front() <= now - m_options.rateWindow) m_recent.pop_front();
+            if ((int)m_recent.size() > m_options.rateLimit) {
+                m_bannedUntil = now + m_options.banDuration;
+                m_recent.clear();
+                std::printf("[mock] %.1fs: over %d requests in %.0fs, banned for %.0fs\n",
+                    now, m_options.rateLimit, m_options.rateWindow, m_options.banDuration);
+                return true;
+            }
+            return false;
+        }
+
+        template <class Value>
+        FilterKey filterFrom(Value const& value, std::string const& query) {
+            auto difficulty = value("diff");
+            auto length = value("len");
+            FilterFields fields;
+            fields.difficulty = difficulty;
+            fields.length = length;
+            fields.query = query;
+            fields.demonFilter = std::atoi(value("demonFilter").c_str());
+            fields.songID = std::atoi(value("song").c_str());
+
+            auto flag = [&](char const* name, FilterFlag bit) {
+                if (value(name) == "1") fields.flags |= bit;
+            };
+            flag("star", StarFilter);
+            flag("noStar", NoStarFilter);
+            flag("featured", FeaturedFilter);
+            flag("epic", EpicFilter);
+            flag("legendary", LegendaryFilter);
+            flag("mythic", MythicFilter);
+            flag("customSong", CustomSongFilter);
+            flag("original", OriginalFilter);
+            flag("twoPlayer", TwoPlayerFilter);
+            flag("coins", CoinsFilter);
+            // Featured (6) and Hall of Fame (16) are rating searches.
+            auto type = std::atoi(value("type").c_str());
+            if (type == 6) fields.flags |= FeaturedFilter;
+            else if (type == 16) fields.flags |= EpicFilter;
+            return FilterKey::from(fields);
+        }
+
+        std::vector<size_t> const& matching(FilterKey const& key, std::string const& query) {
+            auto [it, inserted] = m_matches.try_emplace(key);
+            if (!inserted) return it->second;
+            for (size_t i = 0; i < m_corpus.size(); i++) {
+                auto const& level = m_corpus[i];
+                if (!level.indexed.matches(key)) continue;
+                if (!query.empty() && ("Level " + std::to_string(level.indexed.levelID)).find(query) == std::string::npos) continue;
+                it->second.push_back(i);
+            }
+            return it->second;
+        }
+
+        Reply search(FilterKey const& key, std::string const& query, int page) {
+            auto const& matches = this->matching(key, query);
+            int total = (int)matches.size();
+            int first = page * 10;
+            // Past the 1000th page the server keeps answering with full pages
+            // of levels it already sent instead of running out.
+            bool repeats = m_options.pageGlitch && total >= 10000;
+            int onPage = repeats ? 10 : std::clamp(total - first, 0, 10);
+            if (onPage == 0) return { 200, "-1", "page " + std::to_string(page) + " empty" };
+
+            std::vector<size_t> rows;
+            for (int i = 0; i < onPage; i++) rows.push_back(matches[(size_t)(first + i) % matches.size()]);
+            auto note = "page " + std::to_string(page) + ": " + std::to_string(onPage) + " of " + std::to_string(total);
+            return { 200, this->page(rows, std::min(total, reportedTotalCap), first), note };
+        }
+
+        Reply lookupIDs(std::string_view list) {
+            std::vector<size_t> rows;
+            while (!list.empty()) {
+                auto end = list.find(',');
+                auto it = m_byID.find(std::atoi(std::string(list.substr(0, end)).c_str()));
+                if (it != m_byID.end()) rows.push_back(it->second);
+                list = end == std::string_view::npos ? std::string_view() : list.substr(end + 1);
+            }
+            if (rows.empty()) return { 200, "-1", "ids: none live" };
+            // One page at most, like the real servers.
+            int total = (int)rows.size();
+            if (rows.size() > 10) rows.resize(10);
+            return { 200, this->page(rows, total, 0), "ids: " + std::to_string(total) + " live" };
+        }
+
+        // The trailing hash is a placeholder; the mod's own parser ignores it.
+        std::string page(std::vector<size_t> const& rows, int total, int offset) const {
+            std::string levels;
+            std::string creators;
+            for (auto row : rows) {
+                auto const& level = m_corpus[row];
+                if (!levels.empty()) {
+                    levels += '|';
+                    creators += '|';
+                }
+                levels += level.entry;
+                auto playerID = level.playerID;
+                creators += std::to_string(playerID) + ":Player" + std::to_string(playerID) + ":" + std::to_string(playerID);
+            }
+            return levels + "#" + creators + "##" + std::to_string(total) + ":" + std::to_string(offset) + ":10#0";
+        }
+
+        Options m_options;
+        std::vector<MockLevel> m_corpus;
+        std::unordered_map<int, size_t> m_byID;
+        std::unordered_map<FilterKey, std::vector<size_t>> m_matches;
+        std::chrono::steady_clock::time_point m_started;
+        std::mutex m_mutex;
+        std::deque<double> m_recent;
+        double m_bannedUntil = 0.0;
+        int m_requests = 0;
+    };
+
+    bool sendAll(int socket, std::string_view data) {
+        while (!data.empty()) {
+            auto sent = ::send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            data.remove_prefix((size_t)sent);
+        }
+        return true;
+    }
+
+    // One request per connection; the game's HTTP client does not need
+    // keep-alive to work.
+    void serve(int client, MockServer& server, Options const& options) {
+        std::string request;
+        char buffer[4096];
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = 0;
+        while (true) {
+            if (headerEnd == std::string::npos) {
+                headerEnd = request.find("\r\n\r\n");
+                if (headerEnd != std::string::npos) {
+                    std::string headers = request.substr(0, headerEnd);
+                    std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+                    auto at = headers.find("content-length:");
+                    if (at != std::string::npos) contentLength = std::strtoul(headers.c_str() + at + 15, nullptr, 10);
+                }
+            }
+            if (headerEnd != std::string::npos && request.size() >= headerEnd + 4 + contentLength) break;
+            auto received = ::recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                ::close(client);
+                return;
+            }
+            request.append(buffer, (size_t)received);
+        }
+
+        Reply reply;
+        auto path = std::string_view(request).substr(0, request.find("\r\n"));
+        if (path.find("getGJLevels21.php") == std::string_view::npos) reply = { 404, "-1", "unknown endpoint" };
+        else reply = server.handle(std::string_view(request).substr(headerEnd + 4, contentLength));
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(reply.delay));
+
+        char const* reason = reply.status == 200 ? "OK" : reply.status == 429 ? "Too Many Requests" : "Error";
+        auto response = "HTTP/1.1 " + std::to_string(reply.status) + " " + reason + "\r\n"
+            "Content-Type: text/html; charset=UTF-8\r\n"
+            "Content-Length: " + std::to_string(reply.body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + reply.body;
+        sendAll(client, response);
+        ::close(client);
+
+        if (!options.quiet) std::printf("[mock] %d %s\n", reply.status, reply.note.c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    auto options = parseOptions(argc, argv);
+    MockServer server(options);
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)options.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(listener, 64) != 0) {
+        std::fprintf(stderr, "Cannot listen on port %d: %s\n", options.port, std::strerror(errno));
+        return 1;
+    }
+
+    std::printf(
+        "%zu levels, newest ID %d. Set the mod's Server URL to http://127.0.0.1:%d/database\n"
+        "Rate limit: %d requests per %.0fs, %.0fs ban. Latency %.2fs + up to %.2fs.\n",
+        server.corpus().size(), server.corpus().front().indexed.levelID, options.port,
+        options.rateLimit, options.rateWindow, options.banDuration, options.latency, options.jitter
+    );
+    std::fflush(stdout);
+
+    while (true) {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        std::thread([client, &server, &options] { serve(client, server, options); }).detach();
+    }
+}
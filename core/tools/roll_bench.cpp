@@ -0,0 +1,431 @@
+// Headless roll benchmark: runs every roll mode against the simulated server
+// and reports requests per roll and simulated wall time.
+
+#include <randomlevel/ChaosRoll.hpp>
+#include <randomlevel/DiscoveryEngine.hpp>
+#include <randomlevel/FilterCountCache.hpp>
+#include <randomlevel/RequestScheduler.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include <randomlevel/RollTelemetry.hpp>
+#include <randomlevel/SeenLevels.hpp>
+#include <randomlevel/SimulatedServer.hpp>
+#include "BenchReport.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace randomlevel;
+using namespace randomlevel::bench;
+
+namespace {
+    struct Options {
+        int rolls = 200;
+        uint64_t seed = 42;
+        std::string tracePath;
+    };
+
+    // Rolls run while this is set are also recorded here.
+    RollTelemetry* telemetry = nullptr;
+
+    // Idle time between two rolls, standing in for the player looking at the
+    // level they got before rolling again.
+    constexpr double thinkTime = 3.0;
+
+    struct Scenario {
+        char const* name;
+        SimServerConfig server {};
+        int growthPerRoll = 0;
+    };
+
+    enum class Pacing { Fixed, Scheduled };
+
+    char const* pacingName(Pacing pacing) {
+        return pacing == Pacing::Fixed ? "fixed" : "sched";
+    }
+
+    template <class MakeEngine>
+    Summary runRolls(SimServerConfig config, Pacing pacing, int rolls, uint64_t seed, int growthPerRoll, MakeEngine makeEngine) {
+        SimClock clock;
+        config.seed = seed;
+        SimulatedServer server(clock, config);
+        RollDriver driver(server, clock);
+        RequestScheduler scheduler;
+        if (pacing == Pacing::Scheduled) driver.setScheduler(&scheduler);
+        Rng rng(seed);
+
+        Summary summary;
+        std::vector<double> times;
+        long long totalRequests = 0;
+
+        for (int i = 0; i < rolls; i++) {
+            auto engine = makeEngine(rng);
+            std::optional<RollOutcome> result;
+            driver.run(*engine, [&](RollOutcome const& outcome) { result = outcome; });
+            clock.run();
+
+            if (!result || !result->success) summary.failures++;
+            if (!result) continue;
+            if (telemetry) telemetry->record({ .mode = "bench", .success = result->success, .stats = result->stats });
+
+            if (i == 0) {
+                summary.coldRequests = result->stats.requests;
+                summary.coldTime = result->stats.elapsed();
+            }
+            totalRequests += result->stats.requests;
+            times.push_back(result->stats.elapsed());
+            server.config().totalLevels += growthPerRoll;
+            clock.post(thinkTime, [] {});
+            clock.run();
+        }
+
+        summary.rolls = rolls;
+        summary.bans = server.banCount();
+        summary.meanRequests = rolls ? static_cast<double>(totalRequests) / rolls : 0.0;
+        summary.p50 = percentile(times, 0.50);
+        summary.p99 = percentile(times, 0.99);
+        return summary;
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            if (!std::strcmp(argv[i], "--rolls")) options.rolls = std::atoi(argv[i + 1]);
+            else if (!std::strcmp(argv[i], "--seed")) options.seed = std::strtoull(argv[i + 1], nullptr, 10);
+            else if (!std::strcmp(argv[i], "--trace")) options.tracePath = argv[i + 1];
+        }
+        return options;
+    }
+
+    // The game backend reports an empty page as FailedOrEmpty.
+    Scenario gamePath(Scenario scenario) {
+        scenario.server.emptyAsFailure = true;
+        return scenario;
+    }
+
+    std::vector<Scenario> smartScenarios() {
+        auto shape = [](char const* name, int total, bool reportsTotal, double failureRate = 0.0, int growth = 0) {
+            Scenario scenario{ name };
+            scenario.server.totalLevels = total;
+            scenario.server.reportsTotal = reportsTotal;
+            scenario.server.failureRate = failureRate;
+            scenario.growthPerRoll = growth;
+            return scenario;
+        };
+
+        return {
+            shape("tiny (37)", 37, true),
+            shape("medium (2345)", 2345, true),
+            shape("medium, no total (2345)", 2345, false),
+            shape("capped total (9995)", 9995, true),
+            shape("huge, glitch (250000)", 250000, true),
+            shape("large, growing (4000+3)", 4000, false, 0.0, 3),
+            shape("large, flaky 10% (6789)", 6789, false, 0.10),
+            gamePath(shape("no total, game path (2345)", 2345, false)),
+        };
+    }
+
+    SimServerConfig rateLimited(SimServerConfig config) {
+        config.rateLimit = 60;
+        config.rateWindow = 30.0;
+        config.banDuration = 120.0;
+        return config;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto options = parseOptions(argc, argv);
+
+    RollTelemetry smartTelemetry;
+    telemetry = &smartTelemetry;
+
+    std::printf("Smart RNG (cache persists across rolls)\n");
+    printHeader();
+    for (auto const& scenario : smartScenarios()) {
+        for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop, DiscoveryStrategy::Parallel }) {
+            for (auto pacing : { Pacing::Fixed, Pacing::Scheduled }) {
+                std::optional<int> cache;
+                auto summary = runRolls(scenario.server, pacing, options.rolls, options.seed, scenario.growthPerRoll, [&](Rng& rng) {
+                    auto engine = makeDiscovery(strategy, rng, { .cachedMaxPage = cache });
+                    engine->setHooks({
+                        .maxPageFound = [&](int page) { cache = page; },
+                        .cacheInvalidated = [&]() { cache.reset(); },
+                    });
+                    return engine;
+                });
+                printRow(std::string(scenario.name) + " " + strategyName(strategy) + " " + pacingName(pacing), summary);
+            }
+        }
+    }
+
+    telemetry = nullptr;
+
+    std::printf("\nWhere the Smart rolls above spent their requests\n");
+    std::printf("%-28s %9s %7s %9s %9s %9s\n", "phase", "requests", "share", "failures", "mean s", "paced s");
+    auto const& counters = smartTelemetry.counters();
+    for (auto const& [phase, c] : counters.phases) {
+        std::printf("%-28s %9lld %6.1f%% %9lld %9.3f %9.1f\n", phase.c_str(), c.requests,
+            100.0 * c.requests / std::max(counters.requests, 1LL), c.failures, c.latency / std::max(c.requests, 1LL), c.paced);
+    }
+    if (!options.tracePath.empty()) {
+        std::ofstream(options.tracePath) << smartTelemetry.chromeTrace();
+        std::printf("Trace of the last %zu rolls written to %s\n", smartTelemetry.recent().size(), options.tracePath.c_str());
+    }
+
+    // Each roll is a fresh filter whose broader filter has ~1.5x its levels
+    // and whose narrower one has ~0.6x, like adding or dropping one length.
+    std::printf("\nFirst rolls bounded by related filters (no total, 1000-6000 levels)\n");
+    printHeader();
+    for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop, DiscoveryStrategy::Parallel }) {
+        for (bool bounded : { false, true }) {
+            Summary total;
+            std::vector<double> times;
+            Rng shapes(options.seed);
+            int rolls = std::max(options.rolls / 4, 1);
+            for (int i = 0; i < rolls; i++) {
+                SimServerConfig config;
+                config.totalLevels = shapes.uniformInt(1000, 6000);
+                config.reportsTotal = false;
+                DiscoveryHints hints;
+                if (bounded) {
+                    hints.lowerPage = (int)(config.totalLevels * 0.6) / 10;
+                    hints.upperPage = (int)(config.totalLevels * 1.5) / 10;
+                }
+                auto summary = runRolls(config, Pacing::Fixed, 1, options.seed + i, 0, [&](Rng& rng) {
+                    return makeDiscovery(strategy, rng, hints);
+                });
+                total.failures += summary.failures;
+                total.coldRequests += summary.coldRequests;
+                total.meanRequests += summary.meanRequests / rolls;
+                times.push_back(summary.coldTime);
+            }
+            total.rolls = rolls;
+            total.coldRequests /= rolls;
+            total.coldTime = percentile(times, 0.5);
+            total.p50 = percentile(times, 0.50);
+            total.p99 = percentile(times, 0.99);
+            printRow(std::string(strategyName(strategy)) + (bounded ? " bounded" : " unbounded"), total);
+        }
+    }
+
+    // The player leaves the search layer a few seconds into every attempt
+    // and rolls again until one attempt finishes in time.
+    std::printf("\nSmart RNG interrupted after 3 s, rolled again until done (no total, 1000-6000 levels)\n");
+    printHeader();
+    for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop, DiscoveryStrategy::Parallel }) {
+        for (bool resume : { false, true }) {
+            SimClock clock;
+            SimServerConfig config;
+            config.reportsTotal = false;
+            config.seed = options.seed;
+            SimulatedServer server(clock, config);
+            RollDriver driver(server, clock);
+            Rng rng(options.seed);
+            Rng shapes(options.seed);
+
+            Summary summary;
+            std::vector<double> times;
+            long long totalRequests = 0;
+            summary.rolls = std::max(options.rolls / 4, 1);
+            for (int i = 0; i < summary.rolls; i++) {
+                server.config().totalLevels = shapes.uniformInt(1000, 6000);
+                std::optional<DiscoveryCheckpoint> checkpoint;
+                int requestsBefore = server.requestCount();
+                double startedAt = clock.now();
+                bool done = false;
+
+                for (int attempt = 0; attempt < 20 && !done; attempt++) {
+                    auto engine = makeDiscovery(strategy, rng, { .checkpoint = checkpoint });
+                    if (resume) engine->setHooks({ .checkpointed = [&](DiscoveryCheckpoint const& c) { checkpoint = c; } });
+                    driver.run(*engine, [&](RollOutcome const& outcome) { done = outcome.success; });
+                    clock.post(3.0, [&driver] { driver.cancel(); });
+                    clock.run();
+                }
+
+                int requests = server.requestCount() - requestsBefore;
+                if (!done) summary.failures++;
+                if (i == 0) {
+                    summary.coldRequests = requests;
+                    summary.coldTime = clock.now() - startedAt;
+                }
+                totalRequests += requests;
+                times.push_back(clock.now() - startedAt);
+            }
+            summary.meanRequests = static_cast<double>(totalRequests) / summary.rolls;
+            summary.p50 = percentile(times, 0.50);
+            summary.p99 = percentile(times, 0.99);
+            printRow(std::string(strategyName(strategy)) + (resume ? " resumed" : " from scratch"), summary);
+        }
+    }
+
+    // One roll a day on a filter that keeps growing, with the cache holding
+    // either the last page found or a fitted growth rate to carry it forward.
+    std::printf("\nSmart RNG once a day on a growing filter (no total, 3000 levels)\n");
+    printHeader();
+    for (int perDay : { 45, 150 }) {
+        for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop }) {
+            for (bool growth : { false, true }) {
+                SimServerConfig config;
+                config.totalLevels = 3000;
+                config.reportsTotal = false;
+                std::optional<FilterCountEntry> entry;
+                int day = 0;
+                auto summary = runRolls(config, Pacing::Fixed, options.rolls, options.seed, perDay, [&](Rng& rng) {
+                    double now = 86400.0 * day++;
+                    std::optional<int> cached;
+                    if (entry) cached = growth ? entry->predictedPage(now) : entry->maxPage;
+                    auto engine = makeDiscovery(strategy, rng, { .cachedMaxPage = cached });
+                    engine->setHooks({
+                        .maxPageFound = [&, now](int page) {
+                            entry = entry ? entry->observe(page, now) : FilterCountEntry{ .maxPage = page, .updatedAt = now, .observedSince = now };
+                        },
+                        .cacheInvalidated = [&]() { entry.reset(); },
+                    });
+                    return engine;
+                });
+                printRow("+" + std::to_string(perDay) + "/day " + strategyName(strategy) + (growth ? " growth" : " last page"), summary);
+            }
+        }
+    }
+
+    // A heavy user works through one filter, rolling again whenever a roll
+    // hands back a level they have already been shown.
+    std::printf("\nSmart RNG until 100 new levels, rerolling repeats (Gallop, warm cache)\n");
+    std::printf("%-28s %9s %9s %9s %12s\n", "scenario", "rolls", "repeats", "requests", "new/request");
+    for (int total : { 150, 600 }) {
+        for (bool useSeen : { false, true }) {
+            SimClock clock;
+            SimServerConfig config;
+            config.totalLevels = total;
+            config.seed = options.seed;
+            SimulatedServer server(clock, config);
+            RollDriver driver(server, clock);
+            Rng rng(options.seed);
+            SeenLevels seen;
+            std::optional<int> cache;
+
+            int rolls = 0, repeats = 0, fresh = 0;
+            while (fresh < 100 && rolls < 2000) {
+                auto engine = makeDiscovery(DiscoveryStrategy::Gallop, rng, { .cachedMaxPage = cache });
+                engine->setHooks({ .maxPageFound = [&](int page) { cache = page; } });
+                if (useSeen) engine->setSeenLevels(&seen);
+                std::optional<RollOutcome> result;
+                driver.run(*engine, [&](RollOutcome const& outcome) { result = outcome; });
+                clock.run();
+                rolls++;
+                if (!result || !result->success) continue;
+
+                int levelID = server.levelIDAt(result->page * 10 + result->slot);
+                if (seen.contains(levelID)) repeats++;
+                else fresh++;
+                seen.insert(levelID, clock.now());
+                clock.post(thinkTime, [] {});
+                clock.run();
+            }
+            std::printf("%-28s %9d %9d %9d %12.3f\n", (std::to_string(total) + " levels, " + (useSeen ? "seen set" : "no seen set")).c_str(),
+                rolls, repeats, server.requestCount(), (double)fresh / std::max(server.requestCount(), 1));
+        }
+    }
+
+    std::printf("\nSmart RNG right after browsing the filter (first 5 pages stored, cold cache)\n");
+    printHeader();
+    for (auto const& scenario : smartScenarios()) {
+        if (scenario.growthPerRoll || scenario.server.failureRate > 0.0) continue;
+        for (int stored : { 0, 5 }) {
+            auto config = scenario.server;
+            config.storedPages = stored;
+            auto summary = runRolls(config, Pacing::Scheduled, options.rolls, options.seed, 0, [&](Rng& rng) {
+                return makeDiscovery(DiscoveryStrategy::Gallop, rng, {});
+            });
+            printRow(std::string(scenario.name) + (stored ? " browsed" : " fresh"), summary);
+        }
+    }
+
+    std::printf("\nSmart playlists (10 levels per roll, cold cache every roll)\n");
+    printHeader();
+    for (auto const& scenario : smartScenarios()) {
+        if (scenario.growthPerRoll || scenario.server.failureRate > 0.0) continue;
+        for (int picks : { 1, 10 }) {
+            auto summary = runRolls(scenario.server, Pacing::Scheduled, options.rolls, options.seed, 0, [&](Rng& rng) {
+                auto engine = makeDiscovery(DiscoveryStrategy::Gallop, rng, {});
+                engine->setPickCount(picks);
+                return engine;
+            });
+            printRow(std::string(scenario.name) + " x" + std::to_string(picks), summary);
+        }
+    }
+
+    std::printf("\nChaos RNG (max ID remembered after the first roll)\n");
+    printHeader();
+    for (int batchSize : { 1, 10 }) {
+        for (double density : { 0.6, 0.2, 0.05 }) {
+            for (auto pacing : { Pacing::Fixed, Pacing::Scheduled }) {
+                SimServerConfig config;
+                config.liveIDDensity = density;
+                int maxID = 0;
+                auto summary = runRolls(config, pacing, options.rolls, options.seed, 0, [&](Rng& rng) {
+                    auto engine = std::make_unique<ChaosRoll>(rng, maxID, batchSize);
+                    engine->setHooks({ .maxIDFound = [&](int id) { maxID = id; } });
+                    return engine;
+                });
+                printRow("batch " + std::to_string(batchSize) + ", density " + std::to_string(density).substr(0, 4) +
+                    " " + pacingName(pacing), summary);
+            }
+        }
+    }
+
+    std::printf("\nChaos RNG, small ID space (5000 IDs), dead IDs remembered\n");
+    printHeader();
+    for (bool useIndex : { false, true }) {
+        for (double density : { 0.2, 0.05 }) {
+            SimServerConfig config;
+            config.maxLevelID = 5000;
+            config.liveIDDensity = density;
+            int maxID = 0;
+            ChaosIdIndex index;
+            auto summary = runRolls(config, Pacing::Fixed, options.rolls, options.seed, 0, [&](Rng& rng) {
+                auto engine = std::make_unique<ChaosRoll>(rng, maxID, 1);
+                if (useIndex) engine->setIdIndex(&index);
+                engine->setHooks({
+                    .maxIDFound = [&](int id) { maxID = id; },
+                    .probeAnswered = [&](std::vector<int> const& probed, PageResult const& result) {
+                        index.record(probed, result.levelIDs, maxID, 0.0);
+                    },
+                });
+                return engine;
+            });
+            printRow(std::string(useIndex ? "id index" : "no index") + ", density " + std::to_string(density).substr(0, 4), summary);
+        }
+    }
+
+    std::printf("\nRate-limited server (60 requests / 30 s, 120 s ban)\n");
+    printHeader();
+    for (auto pacing : { Pacing::Fixed, Pacing::Scheduled }) {
+        SimServerConfig config = rateLimited({});
+        config.liveIDDensity = 0.05;
+        int maxID = 0;
+        auto summary = runRolls(config, pacing, options.rolls, options.seed, 0, [&](Rng& rng) {
+            auto engine = std::make_unique<ChaosRoll>(rng, maxID, 1);
+            engine->setHooks({ .maxIDFound = [&](int id) { maxID = id; } });
+            return engine;
+        });
+        printRow(std::string("chaos batch 1, density 0.05 ") + pacingName(pacing), summary);
+    }
+    for (auto pacing : { Pacing::Fixed, Pacing::Scheduled }) {
+        SimServerConfig config = rateLimited({});
+        config.totalLevels = 4321;
+        config.reportsTotal = false;
+        auto summary = runRolls(config, pacing, options.rolls, options.seed, 0, [&](Rng& rng) {
+            return makeDiscovery(DiscoveryStrategy::Bisect, rng, {});
+        });
+        printRow(std::string("smart cold, no total (4321) ") + pacingName(pacing), summary);
+    }
+
+    return 0;
+}
@@ -0,0 +1,278 @@
+// Replay benchmark: runs every Smart discovery strategy against recorded
+// getGJLevels responses and reports requests per roll, simulated latency and
+// cache use per fixture, then times the CPU-side hot paths.
+
+#include <randomlevel/ByteScan.hpp>
+#include <randomlevel/DiscoveryEngine.hpp>
+#include <randomlevel/FilterCountCache.hpp>
+#include <randomlevel/FilterKey.hpp>
+#include <randomlevel/LevelResponse.hpp>
+#include <randomlevel/ReplayServer.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include "BenchReport.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace randomlevel;
+using namespace randomlevel::bench;
+
+#ifndef RANDOMLEVEL_FIXTURE_DIR
+#define RANDOMLEVEL_FIXTURE_DIR "fixtures"
+#endif
+
+namespace {
+    struct Options {
+        int rolls = 200;
+        uint64_t seed = 42;
+        std::string fixtureDir = RANDOMLEVEL_FIXTURE_DIR;
+        int microIterations = 200000;
+    };
+
+    constexpr double thinkTime = 3.0;
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            if (!std::strcmp(argv[i], "--rolls")) options.rolls = std::atoi(argv[i + 1]);
+            else if (!std::strcmp(argv[i], "--seed")) options.seed = std::strtoull(argv[i + 1], nullptr, 10);
+            else if (!std::strcmp(argv[i], "--fixtures")) options.fixtureDir = argv[i + 1];
+            else if (!std::strcmp(argv[i], "--micro")) options.microIterations = std::atoi(argv[i + 1]);
+        }
+        return options;
+    }
+
+    std::vector<ResponseFixture> loadFixtures(std::filesystem::path const& dir) {
+        std::vector<ResponseFixture> fixtures;
+        std::error_code error;
+        for (auto const& entry : std::filesystem::directory_iterator(dir, error)) {
+            if (entry.path().extension() != ".txt") continue;
+            std::ifstream in(entry.path(), std::ios::binary);
+            std::stringstream text;
+            text << in.rdbuf();
+            auto fixture = parseFixture(text.str(), entry.path().stem().string());
+            if (fixture) fixtures.push_back(std::move(*fixture));
+            else std::fprintf(stderr, "Skipping unreadable fixture %s\n", entry.path().string().c_str());
+        }
+        std::sort(fixtures.begin(), fixtures.end(), [](auto const& a, auto const& b) { return a.name < b.name; });
+        return fixtures;
+    }
+
+    // The first roll of a filter starts cold, the rest from the page cache
+    // the earlier ones left, the way the mod's filter cache behaves.
+    Summary replayRolls(ResponseFixture const& fixture, ReplayConfig config, DiscoveryStrategy strategy,
+        int rolls, uint64_t seed, int& cacheHits) {
+        SimClock clock;
+        config.seed = seed;
+        ReplayServer server(clock, fixture, config);
+        RollDriver driver(server, clock);
+        Rng rng(seed);
+
+        Summary summary;
+        std::vector<double> times;
+        long long totalRequests = 0;
+        std::optional<int> cache;
+        cacheHits = 0;
+
+        for (int i = 0; i < rolls; i++) {
+            auto engine = makeDiscovery(strategy, rng, { .cachedMaxPage = cache });
+            engine->setHooks({
+                .maxPageFound = [&](int page) { cache = page; },
+                .cacheInvalidated = [&]() { cache.reset(); },
+            });
+
+            std::optional<RollOutcome> result;
+            driver.run(*engine, [&](RollOutcome const& outcome) { result = outcome; });
+            clock.run();
+
+            if (!result || !result->success) summary.failures++;
+            if (!result) continue;
+            if (result->stats.cache == CacheUse::Hit) cacheHits++;
+            if (i == 0) {
+                summary.coldRequests = result->stats.requests;
+                summary.coldTime = result->stats.elapsed();
+            }
+            totalRequests += result->stats.requests;
+            times.push_back(result->stats.elapsed());
+            clock.post(thinkTime, [] {});
+            clock.run();
+        }
+
+        summary.rolls = rolls;
+        summary.meanRequests = rolls ? static_cast<double>(totalRequests) / rolls : 0.0;
+        summary.p50 = percentile(times, 0.50);
+        summary.p99 = percentile(times, 0.99);
+        return summary;
+    }
+
+    // Runs `body` in a loop and prints the mean time per call. `sink`
+    // keeps the compiler from dropping the work.
+    template <class Body>
+    void timeIt(char const* name, int iterations, Body body) {
+        using namespace std::chrono;
+        volatile uint64_t sink = 0;
+        auto start = steady_clock::now();
+        for (int i = 0; i < iterations; i++) sink = sink + body(i);
+        auto elapsed = duration<double, std::nano>(steady_clock::now() - start).count();
+        std::printf("%-44s %12.1f ns/op\n", name, iterations ? elapsed / iterations : 0.0);
+    }
+
+    // Like timeIt, but for passes over `bytes` bytes of input, in MB/s.
+    template <class Body>
+    void timeThroughput(char const* name, size_t bytes, int passes, Body body) {
+        using namespace std::chrono;
+        volatile uint64_t sink = 0;
+        auto start = steady_clock::now();
+        for (int i = 0; i < passes; i++) sink = sink + body();
+        auto seconds = duration<double>(steady_clock::now() - start).count();
+        std::printf("%-44s %12.1f MB/s\n", name, seconds > 0 ? bytes * (double)passes / seconds / 1e6 : 0.0);
+    }
+
+    void throughput(std::vector<ResponseFixture> const& fixtures, int iterations) {
+        std::vector<std::string_view> bodies;
+        size_t bytes = 0;
+        for (auto const& fixture : fixtures) {
+            for (auto const& [page, responses] : fixture.responses) {
+                for (auto const& body : responses) {
+                    if (body.size() < 64) continue;
+                    bodies.push_back(body);
+                    bytes += body.size();
+                }
+            }
+        }
+        if (bodies.empty()) return;
+
+        int passes = std::max(1, iterations / 1000);
+        std::printf("\nResponse scanning over %zu pages (%s)\n", bodies.size(), byteScanBackend());
+        timeThroughput("scanLevelPage (count + totals)", bytes, passes, [&] {
+            uint64_t levels = 0;
+            for (auto body : bodies) levels += scanLevelPage(body)->count;
+            return levels;
+        });
+        timeThroughput("scanLevelPage + level IDs", bytes, passes, [&] {
+            uint64_t sum = 0;
+            for (auto body : bodies) {
+                scanLevelPage(body)->forEachRecord([&](std::string_view entry) {
+                    sum += levelIntField(entry, "1").value_or(0);
+                });
+            }
+            return sum;
+        });
+        timeThroughput("parseLevelPage (every level)", bytes, passes, [&] {
+            uint64_t levels = 0;
+            for (auto body : bodies) levels += parseLevelPage(body)->levels.size();
+            return levels;
+        });
+        timeThroughput("parseLevelFields (every level)", bytes, passes, [&] {
+            uint64_t sum = 0;
+            for (auto body : bodies) {
+                scanLevelPage(body)->forEachRecord([&](std::string_view entry) {
+                    sum += parseLevelFields(entry)->stars;
+                });
+            }
+            return sum;
+        });
+        timeThroughput("countByte '|'", bytes, passes * 10, [&] {
+            uint64_t count = 0;
+            for (auto body : bodies) count += countByte(body, '|');
+            return count;
+        });
+        timeThroughput("countByteScalar '|'", bytes, passes * 10, [&] {
+            uint64_t count = 0;
+            for (auto body : bodies) count += countByteScalar(body, '|');
+            return count;
+        });
+    }
+
+    void microbenchmarks(std::vector<ResponseFixture> const& fixtures, int iterations) {
+        std::string fullPage;
+        for (auto const& fixture : fixtures) {
+            for (auto const& [page, bodies] : fixture.responses) {
+                for (auto const& body : bodies) {
+                    auto parsed = parseLevelPage(body);
+                    if (parsed && parsed->levels.size() == 10) fullPage = body;
+                }
+            }
+        }
+
+        std::vector<std::string> difficulties = { "-", "1", "1,2", "2,3,4", "-2", "5", "-3", "1,2,3,4,5" };
+        std::vector<std::string> lengths = { "-", "0", "1,2", "3", "4", "0,1,2,3,4" };
+        timeIt("FilterKey::from + hash (search key)", iterations, [&](int i) {
+            FilterFields fields;
+            fields.difficulty = difficulties[i % difficulties.size()];
+            fields.length = lengths[i % lengths.size()];
+            fields.songID = i % 7;
+            fields.flags = static_cast<uint16_t>(i & 0x1ff);
+            return FilterKey::from(fields).hash();
+        });
+
+        FilterCountCache cache(256);
+        std::vector<FilterKey> keys;
+        for (int i = 0; i < 512; i++) {
+            FilterKey key;
+            key.difficultyMask = static_cast<uint16_t>(i);
+            key.flags = static_cast<uint16_t>(i * 7);
+            keys.push_back(key);
+            cache.store(key, { .maxPage = i });
+        }
+        timeIt("FilterCountCache::find (half misses)", iterations, [&](int i) {
+            auto entry = cache.find(keys[i % keys.size()]);
+            return entry ? static_cast<uint64_t>(entry->maxPage) : 0;
+        });
+
+        if (fullPage.empty()) {
+            std::printf("No full page in the fixtures; skipping response parsing.\n");
+            return;
+        }
+        timeIt("parseLevelPage (10 levels)", iterations / 10, [&](int) {
+            auto page = parseLevelPage(fullPage);
+            return page ? page->levels.size() : 0;
+        });
+        auto page = parseLevelPage(fullPage);
+        timeIt("parseLevelFields (1 level)", iterations, [&](int i) {
+            auto const& level = page->levels[i % page->levels.size()];
+            auto fields = parseLevelFields(level.raw.in(fullPage));
+            return fields ? static_cast<uint64_t>(fields->levelID) : 0;
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    auto options = parseOptions(argc, argv);
+    auto fixtures = loadFixtures(options.fixtureDir);
+    if (fixtures.empty()) {
+        std::fprintf(stderr, "No fixtures in %s\n", options.fixtureDir.c_str());
+        return 1;
+    }
+
+    std::printf("Smart RNG replayed from %zu fixtures (cache persists across rolls)\n", fixtures.size());
+    std::printf("%-44s %6s %5s %5s %9s %9s %9s %9s %9s\n",
+        "scenario", "rolls", "fail", "hits", "cold req", "cold s", "req/roll", "p50 s", "p99 s");
+    for (auto const& fixture : fixtures) {
+        for (bool gamePath : { false, true }) {
+            for (auto strategy : { DiscoveryStrategy::Bisect, DiscoveryStrategy::Gallop, DiscoveryStrategy::Parallel }) {
+                ReplayConfig config;
+                config.emptyAsFailure = gamePath;
+                int cacheHits = 0;
+                auto summary = replayRolls(fixture, config, strategy, options.rolls, options.seed, cacheHits);
+                // The bans column carries cache hits here; the replay server never bans.
+                summary.bans = cacheHits;
+                printRow(fixture.name + (gamePath ? " game " : " web ") + strategyName(strategy), summary);
+            }
+        }
+    }
+
+    std::printf("\nCPU hot paths\n");
+    microbenchmarks(fixtures, options.microIterations);
+    throughput(fixtures, options.microIterations);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <randomlevel/PageFetcher.hpp>
+#include <chrono>
+#include <functional>
+
+using namespace geode::prelude;
+
+// One-shot timer on the director's scheduler; a new after() replaces the
+// pending callback. now() is wall-clock time so the request scheduler's state
+// stays meaningful across sessions.
+class CocosTimer : public CCObject, public randomlevel::Timer {
+public:
+    static CocosTimer* create() {
+        auto ret = new CocosTimer();
+        ret->autorelease();
+        return ret;
+    }
+
+    double now() const override {
+        using namespace std::chrono;
+        return duration<double>(system_clock::now().time_since_epoch()).count();
+    }
+
+    void after(double seconds, std::function<void()> callback) override {
+        this->cancel();
+        m_pending = std::move(callback);
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(
+            schedule_selector(CocosTimer::fire), this, 0.0f, 0, static_cast<float>(seconds), false
+        );
+    }
+
+    void cancel() override {
+        CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(schedule_selector(CocosTimer::fire), this);
+        m_pending = nullptr;
+    }
+
+    bool isPending() const { return m_pending != nullptr; }
+
+    void fire(float) {
+        auto callback = std::move(m_pending);
+        this->cancel();
+        if (callback) callback();
+    }
+
+private:
+    std::function<void()> m_pending;
+};
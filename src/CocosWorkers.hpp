@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <randomlevel/WorkerPool.hpp>
+#include <algorithm>
+#include <thread>
+
+using namespace geode::prelude;
+
+// The mod's background threads. Completions run on the cocos thread: the
+// pool is drained once a frame while anything is in flight. Disk writes go
+// to diskLane so writes to one file land in order.
+class CocosWorkers : public CCObject {
+public:
+    static constexpr int diskLane = 0;
+
+    // Lives for the whole session, like the game's own managers.
+    static CocosWorkers* get() {
+        static auto workers = new CocosWorkers();
+        return workers;
+    }
+
+    void run(randomlevel::WorkerPool::Job job, int lane = -1) {
+        m_pool.submit(std::move(job), lane);
+        if (m_scheduled) return;
+        m_scheduled = true;
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(
+            schedule_selector(CocosWorkers::drain), this, 0.0f, false
+        );
+    }
+
+    // Blocks until every job has finished, so nothing is lost when the game
+    // saves and exits.
+    void finish() {
+        m_pool.waitIdle();
+    }
+
+    void drain(float) {
+        m_pool.drain();
+        if (m_pool.pending() > 0) return;
+        m_scheduled = false;
+        CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(schedule_selector(CocosWorkers::drain), this);
+    }
+
+private:
+    CocosWorkers() : m_pool(std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 2)) {}
+
+    randomlevel::WorkerPool m_pool;
+    bool m_scheduled = false;
+};
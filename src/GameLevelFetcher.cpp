@@ -0,0 +1,183 @@
+#include "GameLevelFetcher.hpp"
+#include "RollContext.hpp"
+#include <Geode/modify/GameLevelManager.hpp>
+
+using namespace randomlevel;
+
+static std::unordered_map<std::string, double> g_storedAt;
+static double g_storedPrunedAt = 0.0;
+// Key of the search whose response is being handled, while the server
+// answered it with "-1".
+static std::string g_emptyAnswerKey;
+
+// GameLevelManager reports "-1" through loadLevelsFailed like a request that
+// never got an answer; the HTTP response, seen here just before, tells the
+// two apart.
+class $modify(RandomLevelManager, GameLevelManager) {
+    void onProcessHttpRequestCompleted(CCHttpClient* client, CCHttpResponse* response) {
+        auto data = response ? response->getResponseData() : nullptr;
+        if (response && response->isSucceed() && data && std::string_view(data->data(), data->size()) == "-1") {
+            if (auto tag = response->getHttpRequest()->getTag()) g_emptyAnswerKey = tag;
+        }
+        GameLevelManager::onProcessHttpRequestCompleted(client, response);
+        g_emptyAnswerKey.clear();
+    }
+};
+
+RandomSearchDelegate* RandomSearchDelegate::create(SuccessCallback onSuccess, FailCallback onFail) {
+    auto ret = new RandomSearchDelegate();
+    ret->m_onSuccess = onSuccess;
+    ret->m_onFail = onFail;
+    ret->autorelease();
+    return ret;
+}
+
+void RandomSearchDelegate::invalidate() {
+    m_onSuccess = nullptr;
+    m_onFail = nullptr;
+}
+
+void RandomSearchDelegate::loadLevelsFinished(CCArray* levels, const char* key) {
+    if (m_onSuccess && key) m_onSuccess(key, levels);
+}
+
+void RandomSearchDelegate::loadLevelsFailed(const char* key) {
+    if (m_onFail && key) m_onFail(key);
+}
+
+GameLevelFetcher::GameLevelFetcher(SearchFactory factory) : m_factory(std::move(factory)) {
+    m_delegate = RandomSearchDelegate::create(
+        [this](std::string const& key, CCArray* levels) { this->onLoaded(key, levels); },
+        [this](std::string const& key) { this->onFailed(key); }
+    );
+}
+
+GameLevelFetcher::~GameLevelFetcher() {
+    this->cancel();
+    m_delegate->invalidate();
+}
+
+void GameLevelFetcher::fetch(PageRequest const& request, Callback callback) {
+    auto searchObj = m_factory(request);
+    if (!searchObj) {
+        PageResult result;
+        result.page = request.page;
+        callback(std::move(result));
+        return;
+    }
+
+    // A search already in flight is not sent twice; both callers get its result.
+    std::string key = searchObj->getKey();
+    auto& pending = m_pending[key];
+    bool inFlight = !pending.callbacks.empty();
+    pending.search = searchObj;
+    pending.singleLookup = request.kind == RequestKind::IdLookup && request.ids.size() == 1;
+    pending.callbacks.push_back(std::move(callback));
+    if (inFlight) return;
+
+    GameLevelManager::sharedState()->m_levelManagerDelegate = m_delegate;
+    GameLevelManager::sharedState()->getOnlineLevels(searchObj);
+}
+
+// A stored page past storedMaxAge is never served again, so its entry goes.
+// Sweeping at most once per storedMaxAge keeps the map to the keys stored
+// within the last two windows. A key the browser shows again after its entry
+// went starts a new clock, as a key never seen before does.
+static void pruneStored(double now) {
+    if (now - g_storedPrunedAt < GameLevelFetcher::storedMaxAge) return;
+    g_storedPrunedAt = now;
+    std::erase_if(g_storedAt, [now](auto const& entry) { return now - entry.second > GameLevelFetcher::storedMaxAge; });
+}
+
+std::optional<PageResult> GameLevelFetcher::lookup(PageRequest const& request) {
+    if (request.kind != RequestKind::FilterPage) return std::nullopt;
+    auto searchObj = m_factory(request);
+    if (!searchObj) return std::nullopt;
+
+    std::string key = searchObj->getKey();
+    auto storedAt = g_storedAt.find(key);
+    if (storedAt == g_storedAt.end()) return std::nullopt;
+    if (wallClockNow() - storedAt->second > storedMaxAge) {
+        g_storedAt.erase(storedAt);
+        return std::nullopt;
+    }
+
+    auto manager = GameLevelManager::sharedState();
+    auto levels = manager->getStoredOnlineLevels(key.c_str());
+    if (!levels || levels->count() == 0) return std::nullopt;
+
+    // Page info is stored as "total:offset:amount".
+    PageResult result;
+    result.status = FetchStatus::Ok;
+    result.page = request.page;
+    auto info = string::split(std::string(manager->getPageInfo(key.c_str())), ":");
+    if (!info.empty()) result.total = numFromString<int>(info[0]).unwrapOr(0);
+
+    for (auto level : CCArrayExt<GJGameLevel*>(levels)) {
+        result.levelIDs.push_back(level ? level->m_levelID.value() : 0);
+    }
+    m_pages[result.page] = levels;
+    return result;
+}
+
+void GameLevelFetcher::noteStored(std::string const& key, bool fromServer) {
+    auto now = wallClockNow();
+    pruneStored(now);
+    if (fromServer) g_storedAt[key] = now;
+    else g_storedAt.try_emplace(key, now);
+}
+
+void GameLevelFetcher::cancel() {
+    m_pending.clear();
+    if (GameLevelManager::sharedState()->m_levelManagerDelegate == m_delegate) {
+        GameLevelManager::sharedState()->m_levelManagerDelegate = nullptr;
+    }
+}
+
+GJGameLevel* GameLevelFetcher::levelAt(int page, int slot) {
+    auto it = m_pages.find(page);
+    if (it == m_pages.end() || slot < 0 || slot >= (int)it->second->count()) return nullptr;
+    return typeinfo_cast<GJGameLevel*>(it->second->objectAtIndex(slot));
+}
+
+void GameLevelFetcher::onLoaded(std::string const& key, CCArray* levels) {
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) return;
+    auto pending = std::move(it->second);
+    m_pending.erase(it);
+
+    auto obj = pending.search.data();
+    PageResult result;
+    result.status = FetchStatus::Ok;
+    result.page = obj->m_page;
+    result.total = obj->m_total;
+
+    if (levels) {
+        for (auto level : CCArrayExt<GJGameLevel*>(levels)) {
+            result.levelIDs.push_back(level ? level->m_levelID.value() : 0);
+        }
+        m_pages[result.page] = levels;
+        noteStored(key, true);
+    }
+    else {
+        m_pages.erase(result.page);
+    }
+
+    for (auto& callback : pending.callbacks) callback(result);
+}
+
+void GameLevelFetcher::onFailed(std::string const& key) {
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) return;
+    auto pending = std::move(it->second);
+    m_pending.erase(it);
+
+    // The server's "-1" arrives here as well. For a lookup of one ID that is a
+    // clean answer: the level does not exist. Anything else it says may be an
+    // empty page, but it is no reason to back off like a lost request.
+    PageResult result;
+    if (key != g_emptyAnswerKey) result.status = FetchStatus::Failed;
+    else result.status = pending.singleLookup ? FetchStatus::Ok : FetchStatus::FailedOrEmpty;
+    result.page = pending.search->m_page;
+    for (auto& callback : pending.callbacks) callback(result);
+}
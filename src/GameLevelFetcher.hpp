@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include "LevelPageFetcher.hpp"
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace geode::prelude;
+
+// GameLevelManager reports every search to one delegate slot, tagged with the
+// search key, so one delegate can serve several searches in flight.
+class RandomSearchDelegate : public CCObject, public LevelManagerDelegate {
+public:
+    using SuccessCallback = std::function<void(std::string const&, CCArray*)>;
+    using FailCallback = std::function<void(std::string const&)>;
+
+    SuccessCallback m_onSuccess;
+    FailCallback m_onFail;
+
+    static RandomSearchDelegate* create(SuccessCallback onSuccess, FailCallback onFail);
+
+    void invalidate();
+    void loadLevelsFinished(CCArray* levels, const char* key) override;
+    void loadLevelsFailed(const char* key) override;
+};
+
+// Routes roll requests through GameLevelManager::getOnlineLevels and keeps the
+// level arrays of the current roll so the chosen slot can be opened. Requests
+// are matched to their results by search key, so several can be in flight.
+// Filter pages GameLevelManager still holds from browsing are answered from
+// its store without a request while they are younger than storedMaxAge.
+class GameLevelFetcher : public LevelPageFetcher {
+public:
+    static constexpr double storedMaxAge = 600.0;
+
+    explicit GameLevelFetcher(SearchFactory factory);
+    ~GameLevelFetcher() override;
+
+    void fetch(randomlevel::PageRequest const& request, Callback callback) override;
+    void cancel() override;
+    std::optional<randomlevel::PageResult> lookup(randomlevel::PageRequest const& request) override;
+
+    // Records when GameLevelManager stored the page for a search key. Pages
+    // shown by the level browser may come from the store itself, so those
+    // only start the clock for keys not seen before.
+    static void noteStored(std::string const& key, bool fromServer);
+
+    GJGameLevel* levelAt(int page, int slot) override;
+    void clearPages() override { m_pages.clear(); }
+
+private:
+    struct Pending {
+        Ref<GJSearchObject> search;
+        std::vector<Callback> callbacks;
+        bool singleLookup = false;
+    };
+
+    void onLoaded(std::string const& key, CCArray* levels);
+    void onFailed(std::string const& key);
+
+    SearchFactory m_factory;
+    Ref<RandomSearchDelegate> m_delegate;
+    std::unordered_map<std::string, Pending> m_pending;
+    std::unordered_map<int, Ref<CCArray>> m_pages;
+};
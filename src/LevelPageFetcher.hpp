@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <randomlevel/PageFetcher.hpp>
+#include <functional>
+
+using namespace geode::prelude;
+
+// A page fetcher that can also hand out the level behind a finished roll.
+// Pages are kept until clearPages(), which is called before every roll.
+class LevelPageFetcher : public randomlevel::PageFetcher {
+public:
+    using SearchFactory = std::function<GJSearchObject*(randomlevel::PageRequest const&)>;
+
+    virtual GJGameLevel* levelAt(int page, int slot) = 0;
+    virtual void clearPages() = 0;
+};
@@ -0,0 +1,109 @@
+#include "Preroller.hpp"
+#include "RollContext.hpp"
+#include "WebLevelFetcher.hpp"
+
+using namespace randomlevel;
+
+namespace {
+    constexpr double tickInterval = 2.0;
+    constexpr double successGap = 2.0;
+    constexpr double failureGap = 30.0;
+}
+
+Preroller& Preroller::get() {
+    static auto instance = new Preroller();
+    return *instance;
+}
+
+Preroller::Preroller() : m_chaos(2, 600.0), m_smart(2, 600.0) {
+    m_fetcher = std::make_unique<WebLevelFetcher>([this](PageRequest const& request) {
+        return createRequestObject(request, m_smartSearch);
+    });
+    m_pacingTimer = CocosTimer::create();
+    m_tickTimer = CocosTimer::create();
+    m_driver = std::make_unique<RollDriver>(*m_fetcher, *m_pacingTimer);
+    m_driver->setScheduler(&requestScheduler());
+}
+
+// Going through GameLevelManager would take over its single delegate while
+// the player uses the game's own level pages, so pre-rolling needs the
+// direct backend.
+bool Preroller::enabled() const {
+    return Mod::get()->getSettingValue<bool>("preroll-enabled") && Mod::get()->getSettingValue<bool>("direct-requests");
+}
+
+bool Preroller::inHostScene() const {
+    if (PlayLayer::get()) return false;
+    auto scene = CCDirector::sharedDirector()->getRunningScene();
+    return scene && scene->getChildByType<LevelInfoLayer>(0);
+}
+
+void Preroller::configure() {
+    auto size = (size_t)Mod::get()->getSettingValue<int64_t>("preroll-queue-size");
+    auto maxAge = Mod::get()->getSettingValue<double>("preroll-max-age") * 60.0;
+    m_chaos.configure(size, maxAge);
+    m_smart.configure(size, maxAge);
+}
+
+void Preroller::start() {
+    if (m_started) return;
+    m_started = true;
+    m_tickTimer->after(tickInterval, [this] { this->tick(); });
+}
+
+void Preroller::tick() {
+    m_tickTimer->after(tickInterval, [this] { this->tick(); });
+
+    if (!this->enabled() || !this->inHostScene()) {
+        if (m_driver->running()) m_driver->cancel();
+        return;
+    }
+    if (!m_driver->running() && wallClockNow() >= m_nextRefill) this->refill();
+}
+
+void Preroller::setSmartSource(FilterKey const& filterKey, GJSearchObject* filterSearch) {
+    if (filterKey != m_smart.key() && m_driver->running()) m_driver->cancel();
+    m_smart.setKey(filterKey);
+    m_smartSearch = filterSearch;
+}
+
+Ref<GJGameLevel> Preroller::popChaos() {
+    if (!this->enabled()) return nullptr;
+    return m_chaos.pop(m_chaos.key(), wallClockNow()).value_or(nullptr);
+}
+
+Ref<GJGameLevel> Preroller::popSmart(FilterKey const& filterKey) {
+    if (!this->enabled()) return nullptr;
+    return m_smart.pop(filterKey, wallClockNow()).value_or(nullptr);
+}
+
+void Preroller::refill() {
+    this->configure();
+
+    auto now = wallClockNow();
+    // Searches only the game can answer would fall back to GameLevelManager.
+    bool smart = m_smartSearch && WebLevelFetcher::searchForm(m_smartSearch) && m_smart.wantsMore(now);
+    if (!smart && !m_chaos.wantsMore(now)) return;
+
+    m_fetcher->clearPages();
+    m_engine = smart ? createSmartRoll(m_smart.key()) : createChaosRoll();
+    m_engine->setNoteSink([](std::string const& message) { log::debug("[Random] Preroll: {}", message); });
+    m_driver->run(*m_engine, [this, smart](RollOutcome const& outcome) {
+        this->onRefillFinished(smart, outcome);
+    });
+}
+
+void Preroller::onRefillFinished(bool smart, RollOutcome const& outcome) {
+    if (smart) recordRoll("Preroll Smart", &m_smart.key(), outcome);
+    else recordRoll("Preroll Chaos", nullptr, outcome);
+
+    auto level = outcome.success ? m_fetcher->levelAt(outcome.page, outcome.slot) : nullptr;
+    auto now = wallClockNow();
+
+    if (level) {
+        (smart ? m_smart : m_chaos).push(Ref<GJGameLevel>(level), now);
+        log::debug("[Random] Preroll: queued {} level {}", smart ? "Smart" : "Chaos", level->m_levelID.value());
+    }
+    m_nextRefill = now + (level ? successGap : failureGap);
+    saveScheduler();
+}
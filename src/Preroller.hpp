@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <randomlevel/FilterKey.hpp>
+#include <randomlevel/PrerollQueue.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include "CocosTimer.hpp"
+#include "LevelPageFetcher.hpp"
+#include <memory>
+
+using namespace geode::prelude;
+
+// Keeps a few resolved Chaos levels and Smart levels (for the most recent
+// filter key) ready, so a click can open one without any request. Refills
+// only run with Direct Requests on, while the player sits in a LevelInfoLayer
+// and is not playing, and share the request scheduler with foreground rolls.
+class Preroller {
+public:
+    static Preroller& get();
+
+    void start();
+    void setSmartSource(randomlevel::FilterKey const& filterKey, GJSearchObject* filterSearch);
+
+    Ref<GJGameLevel> popChaos();
+    Ref<GJGameLevel> popSmart(randomlevel::FilterKey const& filterKey);
+
+private:
+    Preroller();
+
+    bool enabled() const;
+    bool inHostScene() const;
+    void configure();
+    void tick();
+    void refill();
+    void onRefillFinished(bool smart, randomlevel::RollOutcome const& outcome);
+
+    randomlevel::PrerollQueue<Ref<GJGameLevel>> m_chaos;
+    randomlevel::PrerollQueue<Ref<GJGameLevel>, randomlevel::FilterKey> m_smart;
+    Ref<GJSearchObject> m_smartSearch;
+
+    std::unique_ptr<LevelPageFetcher> m_fetcher;
+    Ref<CocosTimer> m_pacingTimer;
+    Ref<CocosTimer> m_tickTimer;
+    std::unique_ptr<randomlevel::RollDriver> m_driver;
+    std::unique_ptr<randomlevel::RollEngine> m_engine;
+    bool m_started = false;
+    double m_nextRefill = 0.0;
+};
@@ -0,0 +1,661 @@
+#include "RollContext.hpp"
+#include "CocosTimer.hpp"
+#include "CocosWorkers.hpp"
+#include "GameLevelFetcher.hpp"
+#include "WebLevelFetcher.hpp"
+#include <randomlevel/ChaosIdIndex.hpp>
+#include <randomlevel/ChaosRoll.hpp>
+#include <randomlevel/FilterCountCache.hpp>
+#include <randomlevel/LevelIndex.hpp>
+#include <randomlevel/LocalIndexRoll.hpp>
+#include <randomlevel/MaxIdEstimator.hpp>
+#include <randomlevel/ReplayServer.hpp>
+#include <randomlevel/RollTelemetry.hpp>
+#include <randomlevel/SeenLevels.hpp>
+#include <randomlevel/DiscoveryEngine.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <unordered_map>
+
+using namespace randomlevel;
+
+static MaxIdEstimator g_maxIdEstimator;
+static FilterCountCache g_filterCache;
+static Ref<CocosTimer> g_flushTimer;
+static ChaosIdIndex g_chaosIndex;
+static bool g_chaosIndexLoaded = false;
+static Ref<CocosTimer> g_chaosFlushTimer;
+static SeenLevels g_seenLevels;
+static Ref<CocosTimer> g_seenFlushTimer;
+static std::unordered_map<FilterKey, std::pair<DiscoveryCheckpoint, double>> g_checkpoints;
+static LevelIndex g_levelIndex;
+static bool g_levelIndexLoaded = false;
+static int g_importsInFlight = 0;
+static bool g_levelIndexFlushDeferred = false;
+static Rng g_rng;
+static RequestScheduler g_scheduler;
+static RollTelemetry g_telemetry;
+
+Rng& rollRng() { return g_rng; }
+RequestScheduler& requestScheduler() { return g_scheduler; }
+
+double wallClockNow() {
+    using namespace std::chrono;
+    return duration<double>(system_clock::now().time_since_epoch()).count();
+}
+
+int cachedMaxOnlineID() {
+    return g_maxIdEstimator.predict(wallClockNow()).value_or(0);
+}
+
+// The newest ID actually seen, unlike the prediction above.
+static int observedMaxOnlineID() {
+    auto const& history = g_maxIdEstimator.history();
+    return history.empty() ? 0 : history.back().maxID;
+}
+
+static void loadMaxIdHistory() {
+    auto const saved = Mod::get()->getSavedValue<matjson::Value>("max_online_id");
+    if (!saved.isArray()) return;
+
+    std::vector<IdObservation> history;
+    for (auto const& entry : saved) {
+        auto time = entry.get("time");
+        auto id = entry.get("id");
+        if (!time || !id) continue;
+        history.push_back({ time.unwrap().asDouble().unwrapOr(0.0), (int)id.unwrap().asInt().unwrapOr(0) });
+    }
+    g_maxIdEstimator.restore(std::move(history));
+}
+
+void observeLevelID(int levelID) {
+    if (!g_maxIdEstimator.observe(levelID, wallClockNow())) return;
+
+    auto history = matjson::Value::array();
+    for (auto const& o : g_maxIdEstimator.history()) {
+        history.push(matjson::makeObject({ { "time", o.time }, { "id", o.maxID } }));
+    }
+    Mod::get()->setSavedValue("max_online_id", history);
+}
+
+static void loadScheduler() {
+    g_scheduler.config().maxRate = Mod::get()->getSettingValue<double>("max-requests-per-second");
+    g_scheduler.config().initialRate = std::min(g_scheduler.config().initialRate, g_scheduler.config().maxRate);
+
+    auto const saved = Mod::get()->getSavedValue<matjson::Value>("request_scheduler");
+    auto number = [&](std::string_view key) {
+        auto value = saved.get(key);
+        return value ? value.unwrap().asDouble().unwrapOr(0.0) : 0.0;
+    };
+
+    SchedulerState state;
+    state.rate = number("rate");
+    state.tokens = number("tokens");
+    state.pausedUntil = number("pausedUntil");
+    state.savedAt = number("savedAt");
+    g_scheduler.restore(state, wallClockNow());
+}
+
+void saveScheduler() {
+    auto state = g_scheduler.save(wallClockNow());
+    Mod::get()->setSavedValue("request_scheduler", matjson::makeObject({
+        { "rate", state.rate },
+        { "tokens", state.tokens },
+        { "pausedUntil", state.pausedUntil },
+        { "savedAt", state.savedAt },
+    }));
+}
+
+static void loadTelemetry() {
+    auto const saved = Mod::get()->getSavedValue<matjson::Value>("roll_telemetry");
+    auto number = [](matjson::Value const& object, std::string_view key) {
+        auto value = object.get(key);
+        return value ? value.unwrap().asDouble().unwrapOr(0.0) : 0.0;
+    };
+
+    auto& counters = g_telemetry.counters();
+    counters.rolls = (long long)number(saved, "rolls");
+    counters.successes = (long long)number(saved, "successes");
+    counters.requests = (long long)number(saved, "requests");
+    counters.localHits = (long long)number(saved, "localHits");
+    counters.failures = (long long)number(saved, "failures");
+    counters.cacheHits = (long long)number(saved, "cacheHits");
+    counters.cacheMisses = (long long)number(saved, "cacheMisses");
+    counters.invalidations = (long long)number(saved, "invalidations");
+    counters.rollTime = number(saved, "rollTime");
+    counters.pacingTime = number(saved, "pacingTime");
+
+    if (auto modes = saved.get("modes"); modes && modes.unwrap().isArray()) {
+        for (auto const& entry : modes.unwrap()) {
+            auto name = entry.get("name");
+            if (!name) continue;
+            counters.rollsByMode[name.unwrap().asString().unwrapOr("")] = (long long)number(entry, "rolls");
+        }
+    }
+    if (auto phases = saved.get("phases"); phases && phases.unwrap().isArray()) {
+        for (auto const& entry : phases.unwrap()) {
+            auto name = entry.get("name");
+            if (!name) continue;
+            auto& phase = counters.phases[name.unwrap().asString().unwrapOr("")];
+            phase.requests = (long long)number(entry, "requests");
+            phase.failures = (long long)number(entry, "failures");
+            phase.latency = number(entry, "latency");
+            phase.paced = number(entry, "paced");
+        }
+    }
+}
+
+static void saveTelemetry() {
+    auto const& counters = g_telemetry.counters();
+    auto modes = matjson::Value::array();
+    for (auto const& [name, rolls] : counters.rollsByMode) {
+        modes.push(matjson::makeObject({ { "name", name }, { "rolls", rolls } }));
+    }
+    auto phases = matjson::Value::array();
+    for (auto const& [name, phase] : counters.phases) {
+        phases.push(matjson::makeObject({
+            { "name", name },
+            { "requests", phase.requests },
+            { "failures", phase.failures },
+            { "latency", phase.latency },
+            { "paced", phase.paced },
+        }));
+    }
+
+    Mod::get()->setSavedValue("roll_telemetry", matjson::makeObject({
+        { "rolls", counters.rolls },
+        { "successes", counters.successes },
+        { "requests", counters.requests },
+        { "localHits", counters.localHits },
+        { "failures", counters.failures },
+        { "cacheHits", counters.cacheHits },
+        { "cacheMisses", counters.cacheMisses },
+        { "invalidations", counters.invalidations },
+        { "rollTime", counters.rollTime },
+        { "pacingTime", counters.pacingTime },
+        { "modes", modes },
+        { "phases", phases },
+    }));
+}
+
+void recordRoll(std::string const& mode, FilterKey const* filterKey, RollOutcome const& outcome) {
+    g_telemetry.record({
+        .mode = mode,
+        .filterHash = filterKey ? std::hash<FilterKey>{}(*filterKey) : 0,
+        .success = outcome.success,
+        .stats = outcome.stats,
+    });
+    saveTelemetry();
+
+    if (!Mod::get()->getSettingValue<bool>("trace-export")) return;
+    CocosWorkers::get()->run([telemetry = g_telemetry, path = Mod::get()->getSaveDir() / "roll_trace.json"]() {
+        auto result = file::writeString(path, telemetry.chromeTrace());
+        return result ? WorkerPool::Completion() : [error = result.unwrapErr()] {
+            log::warn("[Random] Failed to write roll trace: {}", error);
+        };
+    }, CocosWorkers::diskLane);
+}
+
+std::string telemetrySummary() {
+    auto const& counters = g_telemetry.counters();
+    if (counters.rolls == 0) return "No rolls yet.";
+
+    auto rolls = (double)counters.rolls;
+    auto lookups = counters.cacheHits + counters.cacheMisses;
+    auto text = fmt::format(
+        "Rolls: {} ({} found a level)\n"
+        "Requests per roll: {:.1f}, stored pages used: {}\n"
+        "Time per roll: {:.2f}s, {:.2f}s of it pacing\n"
+        "Failed requests: {}, cache hits: {}/{}, invalidated: {}",
+        counters.rolls, counters.successes, counters.requests / rolls, counters.localHits,
+        counters.rollTime / rolls, counters.pacingTime / rolls,
+        counters.failures, counters.cacheHits, lookups, counters.invalidations
+    );
+
+    // The phases that cost the most time, send to answer plus pacing.
+    std::vector<std::pair<std::string, PhaseCounters>> phases(counters.phases.begin(), counters.phases.end());
+    std::sort(phases.begin(), phases.end(), [](auto const& a, auto const& b) {
+        return a.second.latency + a.second.paced > b.second.latency + b.second.paced;
+    });
+    if (phases.size() > 3) phases.resize(3);
+    for (auto const& [name, phase] : phases) {
+        text += fmt::format("\n{}: {} requests, {:.2f}s each", name, phase.requests,
+            (phase.latency + phase.paced) / std::max(phase.requests, 1LL));
+    }
+    return text;
+}
+
+void captureResponse(FilterKey const& filterKey, int page, std::string const& body) {
+    if (!Mod::get()->getSettingValue<bool>("capture-fixtures")) return;
+    auto dir = Mod::get()->getSaveDir() / "fixtures";
+    CocosWorkers::get()->run([dir, filterHash = filterKey.hash(), header = fixtureKeyLine(filterKey),
+                              line = fixtureLine(page, body)]() {
+        if (auto result = file::createDirectoryAll(dir); !result) {
+            return WorkerPool::Completion([error = result.unwrapErr()] {
+                log::warn("[Random] Failed to create fixture folder: {}", error);
+            });
+        }
+        auto path = dir / fmt::format("{:016x}.txt", filterHash);
+        bool fresh = !std::filesystem::exists(path);
+        std::ofstream out(path, std::ios::app | std::ios::binary);
+        if (fresh) out << header;
+        out << line;
+        return WorkerPool::Completion();
+    }, CocosWorkers::diskLane);
+}
+
+static std::filesystem::path filterCachePath() {
+    return Mod::get()->getSaveDir() / "filter_cache.bin";
+}
+
+static void loadFilterCache() {
+    g_filterCache.setCapacity((size_t)Mod::get()->getSettingValue<int64_t>("filter-cache-capacity"));
+
+    auto data = file::readBinary(filterCachePath());
+    if (data && !g_filterCache.deserialize(data.unwrap())) {
+        log::warn("[Random] Filter cache file is damaged, starting empty.");
+    }
+}
+
+// The snapshot is taken here; only the disk write runs in the background.
+static void writeInBackground(std::filesystem::path path, std::vector<uint8_t> data, std::string_view what) {
+    CocosWorkers::get()->run([path = std::move(path), data = std::move(data), what]() {
+        auto result = file::writeBinary(path, data);
+        return result ? WorkerPool::Completion() : [what, error = result.unwrapErr()] {
+            log::warn("[Random] Failed to save {}: {}", what, error);
+        };
+    }, CocosWorkers::diskLane);
+}
+
+void flushFilterCache() {
+    if (g_flushTimer) g_flushTimer->cancel();
+    if (g_filterCache.pendingChanges() == 0) return;
+
+    writeInBackground(filterCachePath(), g_filterCache.serialize(), "filter cache");
+}
+
+// Batches cache writes: a burst of updates during a roll becomes one write a
+// few seconds later, or right away once enough changes have piled up.
+template <class Store>
+static void scheduleFlush(Store& store, Ref<CocosTimer>& timer, int flushBatch, void (*flush)()) {
+    constexpr double flushDelay = 10.0;
+
+    if (store.needsFlush(wallClockNow(), flushDelay, flushBatch)) {
+        flush();
+        return;
+    }
+    if (!timer) timer = CocosTimer::create();
+    if (!timer->isPending()) timer->after(flushDelay, flush);
+}
+
+static void scheduleFilterCacheFlush() {
+    scheduleFlush(g_filterCache, g_flushTimer, 32, flushFilterCache);
+}
+
+static std::filesystem::path chaosIndexPath() {
+    return Mod::get()->getSaveDir() / "chaos_ids.bin";
+}
+
+// Only Chaos rolls need the ID index, so it is read on the first one.
+static ChaosIdIndex& chaosIndex() {
+    if (!g_chaosIndexLoaded) {
+        g_chaosIndexLoaded = true;
+        auto data = file::readBinary(chaosIndexPath());
+        if (data && !g_chaosIndex.deserialize(data.unwrap())) {
+            log::warn("[Random] Chaos ID index file is damaged, starting empty.");
+        }
+    }
+    return g_chaosIndex;
+}
+
+static void flushChaosIndex() {
+    if (g_chaosFlushTimer) g_chaosFlushTimer->cancel();
+    if (g_chaosIndex.pendingChanges() == 0) return;
+
+    writeInBackground(chaosIndexPath(), g_chaosIndex.serialize(), "chaos ID index");
+}
+
+static std::filesystem::path seenLevelsPath() {
+    return Mod::get()->getSaveDir() / "seen_levels.bin";
+}
+
+static void loadSeenLevels() {
+    auto data = file::readBinary(seenLevelsPath());
+    if (data && !g_seenLevels.deserialize(data.unwrap())) {
+        log::warn("[Random] Seen level file is damaged, starting empty.");
+    }
+    g_seenLevels.setCapacity((size_t)Mod::get()->getSettingValue<int64_t>("seen-levels-capacity"));
+}
+
+static void flushSeenLevels() {
+    if (g_seenFlushTimer) g_seenFlushTimer->cancel();
+    if (g_seenLevels.pendingChanges() == 0) return;
+
+    writeInBackground(seenLevelsPath(), g_seenLevels.serialize(), "seen levels");
+}
+
+void markLevelSeen(int levelID) {
+    g_seenLevels.insert(levelID, wallClockNow());
+    scheduleFlush(g_seenLevels, g_seenFlushTimer, 16, flushSeenLevels);
+}
+
+static std::filesystem::path levelIndexPath() {
+    return Mod::get()->getSaveDir() / "level_index.bin";
+}
+
+bool localIndexEnabled() {
+    return Mod::get()->getSettingValue<bool>("local-index");
+}
+
+// A JSON dump is an array of objects with the same field names as the CSV
+// columns.
+static std::optional<std::vector<IndexedLevel>> readLevelDump(std::filesystem::path const& path) {
+    auto text = file::readString(path);
+    if (!text) return std::nullopt;
+    if (path.extension() != ".json") return parseLevelDump(text.unwrap());
+
+    auto json = matjson::parse(text.unwrap());
+    if (!json || !json.unwrap().isArray()) return std::nullopt;
+
+    std::vector<IndexedLevel> levels;
+    for (auto const& entry : json.unwrap()) {
+        auto field = [&](std::string_view key) {
+            auto value = entry.get(key);
+            return value ? (int)value.unwrap().asInt().unwrapOr(0) : 0;
+        };
+        LevelFields fields;
+        fields.levelID = field("id");
+        fields.difficulty = field("difficulty");
+        fields.demon = field("demon") != 0;
+        fields.autoLevel = field("auto") != 0;
+        fields.demonDifficulty = field("demon_difficulty");
+        fields.length = field("length");
+        fields.stars = field("stars");
+        fields.featureScore = field("featured");
+        fields.epic = field("epic");
+        fields.audioTrack = field("song");
+        fields.customSong = field("custom_song");
+        if (fields.levelID > 0) levels.push_back(IndexedLevel::from(fields));
+    }
+    return levels;
+}
+
+// Rewriting the index costs a pass over every row, so browsed levels stay in
+// the overlay until the game saves. The file is released before it is
+// replaced because Windows cannot overwrite a mapped file. While a dump is
+// being imported the flush waits for it: the import replays the overlay onto
+// the new file, and a flush in between would fold the overlay into the file
+// about to be replaced and leave nothing to replay.
+static void flushLevelIndex() {
+    if (g_levelIndex.pendingChanges() == 0) return;
+    if (g_importsInFlight > 0) {
+        g_levelIndexFlushDeferred = true;
+        return;
+    }
+
+    auto data = g_levelIndex.serialize();
+    g_levelIndex.close();
+    auto result = file::writeBinary(levelIndexPath(), data);
+    if (!result) log::warn("[Random] Failed to save level index: {}", result.unwrapErr());
+    g_levelIndex.open(levelIndexPath());
+}
+
+static void finishImport() {
+    if (--g_importsInFlight > 0 || !g_levelIndexFlushDeferred) return;
+    g_levelIndexFlushDeferred = false;
+    flushLevelIndex();
+}
+
+// Reading and indexing a dump can take seconds, so it happens in the
+// background and rolls keep using the old index until the new file is swapped
+// in.
+static void importLevelDump(std::filesystem::path const& dump) {
+    auto path = levelIndexPath();
+    auto staging = std::filesystem::path(path).replace_extension(".new");
+    g_importsInFlight++;
+    CocosWorkers::get()->run([dump, path, staging]() -> WorkerPool::Completion {
+        auto levels = readLevelDump(dump);
+        if (!levels) {
+            return [dump] {
+                log::warn("[Random] Could not read level dump {}.", dump.string());
+                finishImport();
+            };
+        }
+        if (auto result = file::writeBinary(staging, LevelIndex::build(std::move(*levels))); !result) {
+            return [error = result.unwrapErr()] {
+                log::warn("[Random] Failed to save level index: {}", error);
+                finishImport();
+            };
+        }
+
+        // Levels browsed since the old file was opened are not in the dump,
+        // so they are replayed onto the new one.
+        return [path, staging] {
+            auto changes = g_levelIndex.changes();
+            g_levelIndex.close();
+            std::error_code error;
+            std::filesystem::rename(staging, path, error);
+            if (error) log::warn("[Random] Failed to replace level index: {}", error.message());
+            g_levelIndex.open(path);
+            g_levelIndex.apply(changes);
+            log::info("[Random] Local level index holds {} levels.", g_levelIndex.size());
+            finishImport();
+        };
+    }, CocosWorkers::diskLane);
+}
+
+// Mapped on the first roll that can use it; a dump is only imported when
+// there is no index file yet or a new dump is picked.
+static LevelIndex& levelIndex() {
+    if (!g_levelIndexLoaded) {
+        g_levelIndexLoaded = true;
+        if (!g_levelIndex.open(levelIndexPath())) {
+            auto dump = Mod::get()->getSettingValue<std::filesystem::path>("level-dump");
+            if (!dump.empty()) importLevelDump(dump);
+        }
+    }
+    return g_levelIndex;
+}
+
+void indexLevel(LevelFields const& fields) {
+    if (!localIndexEnabled()) return;
+    levelIndex().update(IndexedLevel::from(fields));
+}
+
+$execute{
+    loadFilterCache();
+    loadScheduler();
+    loadMaxIdHistory();
+    loadTelemetry();
+    loadSeenLevels();
+
+    listenForSettingChanges("max-requests-per-second", [](double value) {
+        g_scheduler.config().maxRate = value;
+    });
+    listenForSettingChanges("filter-cache-capacity", [](int64_t value) {
+        g_filterCache.setCapacity((size_t)value);
+    });
+    listenForSettingChanges("seen-levels-capacity", [](int64_t value) {
+        g_seenLevels.setCapacity((size_t)value);
+        scheduleFlush(g_seenLevels, g_seenFlushTimer, 16, flushSeenLevels);
+    });
+    listenForSettingChanges("level-dump", [](std::filesystem::path value) {
+        if (value.empty()) return;
+        g_levelIndexLoaded = true;
+        importLevelDump(value);
+    });
+}
+
+$on_mod(DataSaved) {
+    flushFilterCache();
+    flushChaosIndex();
+    flushSeenLevels();
+    flushLevelIndex();
+    CocosWorkers::get()->finish();
+}
+
+FilterKey makeFilterKey(GJSearchObject* obj) {
+    if (!obj) return {};
+
+    uint16_t flags = 0;
+    if (obj->m_starFilter) flags |= StarFilter;
+    if (obj->m_noStarFilter) flags |= NoStarFilter;
+    if (obj->m_featuredFilter) flags |= FeaturedFilter;
+    if (obj->m_epicFilter) flags |= EpicFilter;
+    if (obj->m_legendaryFilter) flags |= LegendaryFilter;
+    if (obj->m_mythicFilter) flags |= MythicFilter;
+    if (obj->m_completedFilter) flags |= CompletedFilter;
+    if (obj->m_uncompletedFilter) flags |= UncompletedFilter;
+    if (obj->m_customSongFilter) flags |= CustomSongFilter;
+    if (obj->m_originalFilter) flags |= OriginalFilter;
+    if (obj->m_twoPlayerFilter) flags |= TwoPlayerFilter;
+    if (obj->m_coinsFilter) flags |= CoinsFilter;
+
+    FilterFields fields;
+    fields.difficulty = std::string_view(obj->m_difficulty.c_str(), obj->m_difficulty.size());
+    fields.length = std::string_view(obj->m_length.c_str(), obj->m_length.size());
+    fields.query = std::string_view(obj->m_searchQuery.c_str(), obj->m_searchQuery.size());
+    fields.demonFilter = (int)obj->m_demonFilter;
+    fields.songID = obj->m_songID;
+    fields.flags = flags;
+    return FilterKey::from(fields);
+}
+
+bool isUsingFilters(GJSearchObject* obj) {
+    auto isSongFilterActive = [](GJSearchObject* o) {
+        if (o->m_customSongFilter != 0) return true;
+        return o->m_songID > 1;
+        };
+
+    return (obj->m_starFilter ||
+        obj->m_noStarFilter ||
+        obj->m_difficulty != "-" ||
+        obj->m_length != "-" ||
+        obj->m_completedFilter ||
+        obj->m_uncompletedFilter ||
+        obj->m_featuredFilter ||
+        obj->m_epicFilter ||
+        obj->m_legendaryFilter ||
+        obj->m_mythicFilter ||
+        obj->m_originalFilter ||
+        obj->m_twoPlayerFilter ||
+        obj->m_coinsFilter ||
+        isSongFilterActive(obj) ||
+        !obj->m_searchQuery.empty());
+}
+
+std::unique_ptr<RollEngine> createChaosRoll() {
+    auto batchSize = Mod::get()->getSettingValue<int64_t>("chaos-batch-size");
+    auto engine = std::make_unique<ChaosRoll>(g_rng, cachedMaxOnlineID(), (int)batchSize);
+    engine->setIdIndex(&chaosIndex());
+    engine->setSeenLevels(&g_seenLevels);
+    engine->setHooks({
+        .maxIDFound = [](int id) { observeLevelID(id); },
+        .probeAnswered = [](std::vector<int> const& probed, PageResult const& result) {
+            g_chaosIndex.record(probed, result.levelIDs, observedMaxOnlineID(), wallClockNow());
+            scheduleFlush(g_chaosIndex, g_chaosFlushTimer, 256, flushChaosIndex);
+        },
+    });
+    return engine;
+}
+
+std::unique_ptr<RollEngine> createSmartRoll(FilterKey const& filterKey, int picks) {
+    if (picks == 1 && localIndexEnabled() && LevelIndex::canAnswer(filterKey) && levelIndex().count(filterKey) > 0) {
+        log::info("[Random] Answering from the local level index.");
+        auto engine = std::make_unique<LocalIndexRoll>(g_rng, g_levelIndex, filterKey);
+        engine->setSeenLevels(&g_seenLevels);
+        engine->setHooks({
+            .levelsMissing = [](std::vector<int> const& ids) {
+                for (int id : ids) g_levelIndex.remove(id);
+                log::info("[Random] Dropped {} deleted levels from the local index.", ids.size());
+            },
+        });
+        return engine;
+    }
+
+    // Related filters only bound this one while their counts are recent.
+    constexpr double boundsMaxAge = 86400.0;
+
+    std::optional<int> cachedPage;
+    if (auto entry = g_filterCache.find(filterKey)) {
+        cachedPage = entry->predictedPage(wallClockNow());
+        if (*cachedPage != entry->maxPage) {
+            log::info("[Random] Page count {} grows about {:.1f} pages a day; expecting Page {}.", entry->maxPage, entry->pagesPerDay, *cachedPage);
+        }
+    }
+    auto bounds = g_filterCache.bounds(filterKey, wallClockNow(), boundsMaxAge);
+    if (!cachedPage && bounds.infinite) cachedPage = 501;
+
+    auto strategyName = Mod::get()->getSettingValue<std::string>("discovery-strategy");
+    auto strategy = DiscoveryStrategy::Gallop;
+    if (strategyName == "Bisect") strategy = DiscoveryStrategy::Bisect;
+    else if (strategyName == "Parallel") strategy = DiscoveryStrategy::Parallel;
+
+    // An interrupted discovery resumes from its bracket while the bracket is
+    // recent; a finished one is in the filter cache instead.
+    constexpr double checkpointMaxAge = 3600.0;
+
+    std::optional<DiscoveryCheckpoint> checkpoint;
+    if (auto it = g_checkpoints.find(filterKey); it != g_checkpoints.end()) {
+        if (!cachedPage && wallClockNow() - it->second.second <= checkpointMaxAge) checkpoint = it->second.first;
+        else g_checkpoints.erase(it);
+    }
+
+    auto width = (int)Mod::get()->getSettingValue<int64_t>("parallel-probes");
+    DiscoveryHints hints{
+        .cachedMaxPage = cachedPage,
+        .lowerPage = bounds.lowerPage,
+        .upperPage = bounds.upperPage,
+        .checkpoint = checkpoint,
+    };
+    if (checkpoint) log::info("[Random] Resuming discovery between Page {} and {}.", checkpoint->lastFull, checkpoint->firstEmpty.value_or(1000));
+    auto engine = makeDiscovery(strategy, g_rng, std::move(hints), width);
+    engine->setPickCount(picks);
+    engine->setSeenLevels(&g_seenLevels);
+    engine->setHooks({
+        .maxPageFound = [filterKey](int page) {
+            g_checkpoints.erase(filterKey);
+            g_filterCache.observe(filterKey, page, wallClockNow());
+            scheduleFilterCacheFlush();
+        },
+        .cacheInvalidated = [filterKey]() {
+            g_checkpoints.erase(filterKey);
+            g_filterCache.erase(filterKey, wallClockNow());
+            scheduleFilterCacheFlush();
+        },
+        .checkpointed = [filterKey](DiscoveryCheckpoint const& checkpoint) {
+            g_checkpoints[filterKey] = { checkpoint, wallClockNow() };
+        },
+    });
+    return engine;
+}
+
+GJSearchObject* createRequestObject(PageRequest const& request, GJSearchObject* filterSearch) {
+    switch (request.kind) {
+    case RequestKind::Recent:
+        return GJSearchObject::create(SearchType::Recent);
+    case RequestKind::IdLookup: {
+        if (request.ids.empty()) return nullptr;
+        if (request.ids.size() == 1) {
+            return GJSearchObject::create(SearchType::Search, std::to_string(request.ids.front()));
+        }
+        std::string idList;
+        for (int id : request.ids) {
+            if (!idList.empty()) idList += ",";
+            idList += std::to_string(id);
+        }
+        return GJSearchObject::create(SearchType::MapPackOnClick, idList);
+    }
+    default:
+        return filterSearch ? filterSearch->getPageObject(request.page) : nullptr;
+    }
+}
+
+std::unique_ptr<LevelPageFetcher> createLevelFetcher(LevelPageFetcher::SearchFactory factory) {
+    if (Mod::get()->getSettingValue<bool>("direct-requests")) {
+        return std::make_unique<WebLevelFetcher>(std::move(factory));
+    }
+    return std::make_unique<GameLevelFetcher>(std::move(factory));
+}
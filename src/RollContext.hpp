@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <randomlevel/FilterKey.hpp>
+#include <randomlevel/LevelResponse.hpp>
+#include <randomlevel/Random.hpp>
+#include <randomlevel/RequestScheduler.hpp>
+#include <randomlevel/RollDriver.hpp>
+#include <randomlevel/RollEngine.hpp>
+#include "LevelPageFetcher.hpp"
+#include <memory>
+#include <string>
+
+using namespace geode::prelude;
+
+// State shared by every roll, whether started from the search layer or by
+// the background pre-roller.
+randomlevel::Rng& rollRng();
+randomlevel::RequestScheduler& requestScheduler();
+void saveScheduler();
+double wallClockNow();
+// Newest online level ID, extrapolated from the IDs seen so far; 0 if none.
+int cachedMaxOnlineID();
+void observeLevelID(int levelID);
+bool localIndexEnabled();
+// Feeds the local level index when it is enabled.
+void indexLevel(randomlevel::LevelFields const& fields);
+// Remembers a level the player has been shown, so rolls steer around it.
+void markLevelSeen(int levelID);
+
+// Adds a finished roll to the telemetry counters and, when enabled, the
+// trace file. filterKey is null for rolls without filters.
+void recordRoll(std::string const& mode, randomlevel::FilterKey const* filterKey, randomlevel::RollOutcome const& outcome);
+std::string telemetrySummary();
+// Appends a raw getGJLevels response to fixtures/<filter hash>.txt in the
+// save folder when enabled, in the format roll-replay reads.
+void captureResponse(randomlevel::FilterKey const& filterKey, int page, std::string const& body);
+
+randomlevel::FilterKey makeFilterKey(GJSearchObject* obj);
+bool isUsingFilters(GJSearchObject* obj);
+void flushFilterCache();
+
+std::unique_ptr<randomlevel::RollEngine> createChaosRoll();
+std::unique_ptr<randomlevel::RollEngine> createSmartRoll(randomlevel::FilterKey const& filterKey, int picks = 1);
+
+GJSearchObject* createRequestObject(randomlevel::PageRequest const& request, GJSearchObject* filterSearch);
+std::unique_ptr<LevelPageFetcher> createLevelFetcher(LevelPageFetcher::SearchFactory factory);
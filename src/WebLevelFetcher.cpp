@@ -0,0 +1,202 @@
+#include "WebLevelFetcher.hpp"
+#include "CocosWorkers.hpp"
+#include "RollContext.hpp"
+#include <algorithm>
+#include <cctype>
+
+using namespace randomlevel;
+
+namespace {
+    // The Server URL setting lets testing point Direct Requests at a local
+    // stand-in such as core/tools/mock_server.cpp.
+    std::string levelsEndpoint() {
+        auto base = Mod::get()->getSettingValue<std::string>("server-url");
+        while (!base.empty() && base.back() == '/') base.pop_back();
+        if (base.empty()) base = "https://www.boomlings.com/database";
+        return base + "/getGJLevels21.php";
+    }
+
+    struct ParsedPage {
+        PageResult result;
+        std::vector<LevelFields> fields;
+    };
+
+    // Rolls only need the level IDs and the total; whole levels are decoded
+    // for the local index, if it is on, and for the one level a roll lands on.
+    ParsedPage parsePage(int page, std::string_view body, bool indexing) {
+        ParsedPage parsed;
+        parsed.result.page = page;
+
+        auto scan = scanLevelPage(body);
+        if (!scan) return parsed;
+        scan->forEachRecord([&](std::string_view entry) {
+            parsed.result.levelIDs.push_back(levelIntField(entry, "1").value_or(0));
+            if (!indexing) return;
+            if (auto fields = parseLevelFields(entry)) parsed.fields.push_back(*fields);
+        });
+        if (std::ranges::find(parsed.result.levelIDs, 0) != parsed.result.levelIDs.end()) return { .result = { .page = page } };
+
+        parsed.result.status = FetchStatus::Ok;
+        parsed.result.total = scan->total;
+        return parsed;
+    }
+
+    std::string formEscape(std::string_view text) {
+        static constexpr char hex[] = "0123456789ABCDEF";
+        std::string out;
+        for (unsigned char c : text) {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == ',') {
+                out += static_cast<char>(c);
+            }
+            else {
+                out += '%';
+                out += hex[c >> 4];
+                out += hex[c & 15];
+            }
+        }
+        return out;
+    }
+}
+
+WebLevelFetcher::WebLevelFetcher(SearchFactory factory)
+    : m_factory(factory), m_fallback(factory) {}
+
+WebLevelFetcher::~WebLevelFetcher() {
+    this->cancel();
+}
+
+std::optional<std::string> WebLevelFetcher::searchForm(GJSearchObject* search) {
+    switch (search->m_searchType) {
+    case SearchType::Followed:
+    case SearchType::Friends:
+        return std::nullopt;
+    default:
+        break;
+    }
+    if (search->m_completedFilter || search->m_uncompletedFilter) return std::nullopt;
+
+    auto form = fmt::format(
+        "gameVersion=22&binaryVersion=45&secret=Wmfd2893gb7&type={}&str={}&diff={}&len={}&page={}&total=0",
+        (int)search->m_searchType, formEscape(std::string(search->m_searchQuery)),
+        formEscape(std::string(search->m_difficulty)), formEscape(std::string(search->m_length)), search->m_page
+    );
+
+    auto flag = [&](char const* name, bool on) {
+        if (on) form += fmt::format("&{}=1", name);
+    };
+    flag("star", search->m_starFilter);
+    flag("noStar", search->m_noStarFilter);
+    flag("featured", search->m_featuredFilter);
+    flag("original", search->m_originalFilter);
+    flag("twoPlayer", search->m_twoPlayerFilter);
+    flag("coins", search->m_coinsFilter);
+    flag("epic", search->m_epicFilter);
+    flag("legendary", search->m_legendaryFilter);
+    flag("mythic", search->m_mythicFilter);
+
+    if (search->m_customSongFilter != 0 || search->m_songID > 1) {
+        form += fmt::format("&song={}", search->m_songID);
+        flag("customSong", search->m_customSongFilter);
+    }
+    if (search->m_difficulty == "-2" && (int)search->m_demonFilter > 0) {
+        form += fmt::format("&demonFilter={}", (int)search->m_demonFilter);
+    }
+    return form;
+}
+
+void WebLevelFetcher::fetch(PageRequest const& request, Callback callback) {
+    auto search = m_factory(request);
+    auto form = search ? searchForm(search) : std::nullopt;
+    if (!form) {
+        m_fallback.fetch(request, std::move(callback));
+        return;
+    }
+
+    std::optional<FilterKey> capture;
+    if (request.kind == RequestKind::FilterPage) capture = makeFilterKey(search);
+
+    auto id = m_nextTask++;
+    auto task = web::WebRequest()
+        .userAgent("")
+        .timeout(std::chrono::seconds(10))
+        .header("Content-Type", "application/x-www-form-urlencoded")
+        .bodyString(*form)
+        .post(levelsEndpoint());
+    m_tasks.emplace(id, task);
+
+    task.listen(
+        [this, id, page = request.page, capture, callback = std::move(callback)](web::WebResponse* response) {
+            m_tasks.erase(id);
+            this->onResponse(page, capture, response, callback);
+        },
+        [](web::WebProgress*) {},
+        [] {}
+    );
+}
+
+// Pages the player browsed are in GameLevelManager's store, not ours; a page
+// answered from there must not be shadowed by an older response of ours.
+std::optional<PageResult> WebLevelFetcher::lookup(PageRequest const& request) {
+    auto result = m_fallback.lookup(request);
+    if (result) m_pages.erase(result->page);
+    return result;
+}
+
+// Parsing runs on a worker. The page is stored and the callback runs back on
+// the main thread, unless the fetcher was cancelled or destroyed meanwhile.
+void WebLevelFetcher::onResponse(
+    int page, std::optional<FilterKey> capture, web::WebResponse* response, Callback const& callback
+) {
+    if (!response->ok()) {
+        m_pages.erase(page);
+        callback({ .status = FetchStatus::Failed, .page = page });
+        return;
+    }
+
+    auto body = response->string().unwrapOr("");
+    if (capture) captureResponse(*capture, page, body);
+    CocosWorkers::get()->run([this, page, indexing = localIndexEnabled(), body = std::move(body),
+                              alive = std::weak_ptr(m_alive), callback]() mutable {
+        auto parsed = parsePage(page, body, indexing);
+        return WorkerPool::Completion([this, page, body = std::move(body), parsed = std::move(parsed),
+                                       alive, callback]() mutable {
+            if (alive.expired()) return;
+            for (auto const& fields : parsed.fields) indexLevel(fields);
+            if (parsed.result.ok()) m_pages[page] = std::move(body);
+            else m_pages.erase(page);
+            callback(std::move(parsed.result));
+        });
+    });
+}
+
+void WebLevelFetcher::cancel() {
+    m_alive = std::make_shared<bool>(true);
+    auto tasks = std::move(m_tasks);
+    m_tasks.clear();
+    for (auto& [id, task] : tasks) task.cancel();
+    m_fallback.cancel();
+}
+
+GJGameLevel* WebLevelFetcher::levelAt(int page, int slot) {
+    auto it = m_pages.find(page);
+    if (it == m_pages.end()) return m_fallback.levelAt(page, slot);
+
+    auto const& body = it->second;
+    auto parsed = parseLevelPage(body);
+    if (!parsed || slot < 0 || slot >= (int)parsed->levels.size()) return nullptr;
+
+    auto const& summary = parsed->levels[slot];
+    auto level = GJGameLevel::create(GameLevelManager::responseToDict(std::string(summary.raw.in(body)), false), false);
+    if (!level) return nullptr;
+
+    if (auto creator = parsed->creator(summary.playerID)) {
+        level->m_creatorName = std::string(creator->name.in(body));
+        level->m_accountID = creator->accountID;
+    }
+    return level;
+}
+
+void WebLevelFetcher::clearPages() {
+    m_pages.clear();
+    m_fallback.clearPages();
+}
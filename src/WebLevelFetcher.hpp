@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <Geode/utils/web.hpp>
+#include <randomlevel/FilterKey.hpp>
+#include <randomlevel/LevelResponse.hpp>
+#include "GameLevelFetcher.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+using namespace geode::prelude;
+
+// Sends getGJLevels21 requests itself and keeps each page as the raw response,
+// so probes never go through GameLevelManager. A full GJGameLevel is only
+// built for the level a roll lands on. Searches that need data only the game
+// has (completed levels, account lists) fall back to the GameLevelManager
+// route.
+class WebLevelFetcher : public LevelPageFetcher {
+public:
+    explicit WebLevelFetcher(SearchFactory factory);
+    ~WebLevelFetcher() override;
+
+    void fetch(randomlevel::PageRequest const& request, Callback callback) override;
+    void cancel() override;
+    std::optional<randomlevel::PageResult> lookup(randomlevel::PageRequest const& request) override;
+
+    GJGameLevel* levelAt(int page, int slot) override;
+    void clearPages() override;
+
+    static std::optional<std::string> searchForm(GJSearchObject* search);
+
+private:
+    void onResponse(
+        int page, std::optional<randomlevel::FilterKey> capture, web::WebResponse* response, Callback const& callback
+    );
+
+    SearchFactory m_factory;
+    GameLevelFetcher m_fallback;
+    std::unordered_map<uint64_t, web::WebTask> m_tasks;
+    uint64_t m_nextTask = 0;
+    std::unordered_map<int, std::string> m_pages;
+    // Replaced on cancel(), so parses still in flight are dropped.
+    std::shared_ptr<bool> m_alive = std::make_shared<bool>(true);
+};
@@ -2,93 +2,49 @@
 #include <Geode/modify/LevelSearchLayer.hpp>
 #include <Geode/modify/LevelInfoLayer.hpp>
 #include <Geode/modify/GJSearchObject.hpp>
+#include <Geode/modify/LevelBrowserLayer.hpp>
 #include <Geode/utils/cocos.hpp>
-#include <random>
-#include <chrono>
-#include <map>
+#include "CocosTimer.hpp"
+#include "GameLevelFetcher.hpp"
+#include "LevelPageFetcher.hpp"
+#include "Preroller.hpp"
+#include "RollContext.hpp"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <optional>
 #include <string>
-#include <sstream>
 
 using namespace geode::prelude;
+using namespace randomlevel;
 
 static bool g_enteredViaRandom = false;
-static int g_cachedMaxOnlineID = 0;
-static std::map<std::string, int> g_filterCache;
-
-static int generateRandomInt(int min, int max) {
-    static std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<int> dist(min, max);
-    return dist(rng);
-}
-
-$execute{
-    g_filterCache = Mod::get()->getSavedValue<std::map<std::string, int>>("filter_cache");
+// Rest of the current playlist, played in order as each level is left.
+static std::deque<Ref<GJGameLevel>> g_playlist;
+
+static void openRandomLevel(GJGameLevel* level) {
+    g_enteredViaRandom = true;
+    auto saved = GameLevelManager::sharedState()->getSavedLevel(level->m_levelID);
+    auto scene = LevelInfoLayer::scene(saved ? saved : level, false);
+    CCDirector::sharedDirector()->replaceScene(CCTransitionFade::create(0.5f, scene));
 }
 
-std::string getSearchKey(GJSearchObject* obj) {
-    if (!obj) return "";
-
-    std::stringstream ss;
-    ss << "Diff:" << obj->m_difficulty
-        << "_Len:" << obj->m_length
-        << "_Star:" << (int)obj->m_starFilter
-        << "_NoStar:" << (int)obj->m_noStarFilter
-        << "_Feat:" << (int)obj->m_featuredFilter
-        << "_Epic:" << (int)obj->m_epicFilter
-        << "_Leg:" << (int)obj->m_legendaryFilter
-        << "_Myth:" << (int)obj->m_mythicFilter
-        << "_Song:" << obj->m_songID
-        << "_Custom:" << (int)obj->m_customSongFilter;
-
-    if (!obj->m_searchQuery.empty()) {
-        ss << "_Q:" << obj->m_searchQuery;
-    }
-    return ss.str();
-}
-
-class RandomSearchDelegate : public CCObject, public LevelManagerDelegate {
-public:
-    using SuccessCallback = std::function<void(GJSearchObject*, CCArray*)>;
-    using FailCallback = std::function<void(GJSearchObject*)>;
-
-    SuccessCallback m_onSuccess;
-    FailCallback m_onFail;
-    GJSearchObject* m_currentSearchObj = nullptr;
-
-    static RandomSearchDelegate* create(SuccessCallback onSuccess, FailCallback onFail) {
-        auto ret = new RandomSearchDelegate();
-        ret->m_onSuccess = onSuccess;
-        ret->m_onFail = onFail;
-        ret->autorelease();
-        return ret;
-    }
-
-    void invalidate() {
-        m_onSuccess = nullptr;
-        m_onFail = nullptr;
-    }
-
-    void loadLevelsFinished(CCArray* levels, const char* page) override {
-        if (m_onSuccess && m_currentSearchObj) m_onSuccess(m_currentSearchObj, levels);
-    }
-
-    void loadLevelsFailed(const char* page) override {
-        if (m_onFail && m_currentSearchObj) m_onFail(m_currentSearchObj);
-    }
-
-    void setupSearch(GJSearchObject* obj) {
-        CC_SAFE_RELEASE(m_currentSearchObj);
-        m_currentSearchObj = obj;
-        CC_SAFE_RETAIN(m_currentSearchObj);
-    }
-
-    ~RandomSearchDelegate() {
-        CC_SAFE_RELEASE(m_currentSearchObj);
+class $modify(RandomLevelInfoLayer, LevelInfoLayer) {
+    // Levels opened from anywhere count as seen, not just rolled ones.
+    bool init(GJGameLevel * level, bool challenge) {
+        if (!LevelInfoLayer::init(level, challenge)) return false;
+        if (level) markLevelSeen(level->m_levelID.value());
+        return true;
     }
-};
 
-class $modify(RandomLevelInfoLayer, LevelInfoLayer) {
     void onBack(CCObject * sender) {
+        if (g_enteredViaRandom && !g_playlist.empty()) {
+            Ref<GJGameLevel> next = g_playlist.front();
+            g_playlist.pop_front();
+            log::info("[Random] Playlist: next level {} ({} left).", next->m_levelID.value(), g_playlist.size());
+            openRandomLevel(next);
+            return;
+        }
         if (g_enteredViaRandom) {
             g_enteredViaRandom = false;
             auto scene = LevelSearchLayer::scene(0);
@@ -99,43 +55,62 @@ class $modify(RandomLevelInfoLayer, LevelInfoLayer) {
     }
 };
 
+static LevelFields levelFields(GJGameLevel* level) {
+    LevelFields fields;
+    fields.levelID = level->m_levelID.value();
+    fields.difficulty = level->m_ratings > 0 ? level->m_ratingsSum * 10 / level->m_ratings : 0;
+    fields.demon = level->m_demon.value() != 0;
+    fields.autoLevel = level->m_autoLevel;
+    fields.demonDifficulty = level->m_demonDifficulty;
+    fields.length = level->m_levelLength;
+    fields.stars = level->m_stars.value();
+    fields.featureScore = level->m_featured;
+    fields.epic = level->m_isEpic;
+    fields.audioTrack = level->m_audioTrack;
+    fields.customSong = level->m_songID;
+    return fields;
+}
+
+// Every level list the player browses feeds the local level index. Recent
+// lists also keep the newest-ID estimate fresh, so Chaos rarely has to ask
+// the Recent tab itself; the newest ID of any other list can be months old
+// and would skew the fitted upload rate.
+class $modify(RandomLevelBrowser, LevelBrowserLayer) {
+    void loadLevelsFinished(CCArray * levels, char const* key, int type) {
+        LevelBrowserLayer::loadLevelsFinished(levels, key, type);
+        if (!levels) return;
+        if (key) GameLevelFetcher::noteStored(key, false);
+
+        int newest = 0;
+        for (auto object : CCArrayExt<CCObject*>(levels)) {
+            auto level = typeinfo_cast<GJGameLevel*>(object);
+            if (!level) continue;
+            newest = std::max(newest, level->m_levelID.value());
+            indexLevel(levelFields(level));
+        }
+        if (m_searchObject && m_searchObject->m_searchType == SearchType::Recent) observeLevelID(newest);
+    }
+};
+
 class $modify(RandomLevelSearch, LevelSearchLayer) {
-    enum class RandomMode { None, Smart, Chaos };
-
-    enum class SmartPhase {
-        Idle,
-        Phase1_CheckTotal,
-        Phase2_CachePeek,
-        Phase2b_CacheNext,
-        Phase3_GlitchCheck,
-        Phase4_BinarySearch,
-        Phase5_CalcExact,
-        Phase6_FetchTarget
-    };
+    enum class RandomMode { None, Smart, Chaos, Playlist };
 
     struct Fields {
         RandomMode m_currentMode = RandomMode::None;
-        SmartPhase m_smartPhase = SmartPhase::Idle;
         LoadingCircle* m_loadingCircle = nullptr;
-        Ref<RandomSearchDelegate> m_delegate = nullptr;
-
-        bool m_usingFilters = false;
-        std::string m_currentFilterKey;
-
-        int m_searchLow = 0;
-        int m_searchHigh = 0;
-        int m_foundMaxPage = 0;
 
-        int m_targetPage = 0;
-        int m_targetSlot = 0;
-
-        int m_retryCount = 0;
-        bool m_isFetchingLatest = false;
+        std::unique_ptr<LevelPageFetcher> m_fetcher;
+        Ref<CocosTimer> m_timer;
+        std::unique_ptr<RollDriver> m_driver;
+        std::unique_ptr<RollEngine> m_engine;
+        Ref<GJSearchObject> m_filterSearch;
     };
 
     bool init(int p0) {
         if (!LevelSearchLayer::init(p0)) return false;
         g_enteredViaRandom = false;
+        g_playlist.clear();
+        Preroller::get().start();
 
         auto winSize = CCDirector::sharedDirector()->getWinSize();
         auto menu = CCMenu::create();
@@ -179,6 +154,24 @@ class $modify(RandomLevelSearch, LevelSearchLayer) {
             auto btnSmart = CCMenuItemSpriteExtra::create(smartBtnSprite, this, menu_selector(RandomLevelSearch::onSmartRandom));
             menu->addChild(btnSmart);
         }
+
+        auto playlistLabel = CCLabelBMFont::create(
+            fmt::format("x{}", Mod::get()->getSettingValue<int64_t>("playlist-size")).c_str(), "bigFont.fnt"
+        );
+        playlistLabel->setScale(0.5f);
+        auto playlistBtnSprite = CircleButtonSprite::create(playlistLabel, CircleBaseColor::Green, CircleBaseSize::Medium);
+        if (playlistBtnSprite) {
+            playlistBtnSprite->setScale(0.8f);
+            auto btnPlaylist = CCMenuItemSpriteExtra::create(playlistBtnSprite, this, menu_selector(RandomLevelSearch::onPlaylistRandom));
+            btnPlaylist->setID("playlist-button"_spr);
+            menu->addChild(btnPlaylist);
+        }
+
+        auto statsSprite = CCSprite::createWithSpriteFrameName("GJ_infoIcon_001.png");
+        statsSprite->setScale(0.7f);
+        auto btnStats = CCMenuItemSpriteExtra::create(statsSprite, this, menu_selector(RandomLevelSearch::onRandomStats));
+        btnStats->setID("stats-button"_spr);
+        menu->addChild(btnStats);
         menu->updateLayout();
         return true;
     }
@@ -192,6 +185,10 @@ class $modify(RandomLevelSearch, LevelSearchLayer) {
         }
     }
 
+    void onRandomStats(CCObject * sender) {
+        FLAlertLayer::create(nullptr, "Random Stats", telemetrySummary(), "OK", nullptr, 380.f)->show();
+    }
+
     void onChaosRandom(CCObject * sender) {
         if (GJAccountManager::sharedState()->m_accountID <= 0) return;
         if (m_fields->m_currentMode != RandomMode::None) return;
@@ -202,11 +199,17 @@ class $modify(RandomLevelSearch, LevelSearchLayer) {
 
     void deferredChaosSearch(float) {
         m_fields->m_currentMode = RandomMode::Chaos;
-        m_fields->m_isFetchingLatest = (g_cachedMaxOnlineID == 0);
         log::info("[Random] Mode: CHAOS");
+        this->startChaosRoll();
+    }
 
-        this->startRandomSearch();
-        this->attemptSearch();
+    void startChaosRoll() {
+        if (auto level = Preroller::get().popChaos()) {
+            log::info("[Random] Using pre-rolled Chaos level.");
+            this->openLevelPage(level, std::nullopt);
+            return;
+        }
+        this->startRoll(createChaosRoll());
     }
 
     void onSmartRandom(CCObject * sender) {
@@ -217,391 +220,140 @@ class $modify(RandomLevelSearch, LevelSearchLayer) {
         this->scheduleOnce(schedule_selector(RandomLevelSearch::deferredSmartSearch), 0.0f);
     }
 
-    void deferredSmartSearch(float) {
-        m_fields->m_currentMode = RandomMode::Smart;
+    void onPlaylistRandom(CCObject * sender) {
+        if (GJAccountManager::sharedState()->m_accountID <= 0) return;
+        if (m_fields->m_currentMode != RandomMode::None) return;
+
+        showLoading();
+        this->scheduleOnce(schedule_selector(RandomLevelSearch::deferredPlaylistSearch), 0.0f);
+    }
+
+    // One discovery pass for the current filters, then a batch of distinct
+    // levels from it. Needs filters: without them there is no page count to
+    // draw from.
+    void deferredPlaylistSearch(float) {
+        m_fields->m_currentMode = RandomMode::Playlist;
 
         auto testObj = this->getSearchObject(SearchType::Search, "");
         if (!testObj) {
             this->abortSearch("Failed to create search object.");
             return;
         }
-
-        auto isSongFilterActive = [](GJSearchObject* o) {
-            if (o->m_customSongFilter != 0) return true;
-            return o->m_songID > 1;
-            };
-
-        log::info("[Random] Smart Search Started.");
-
-        m_fields->m_usingFilters =
-            (testObj->m_starFilter ||
-                testObj->m_noStarFilter ||
-                testObj->m_difficulty != "-" ||
-                testObj->m_length != "-" ||
-                testObj->m_completedFilter ||
-                testObj->m_uncompletedFilter ||
-                testObj->m_featuredFilter ||
-                testObj->m_epicFilter ||
-                testObj->m_legendaryFilter ||
-                testObj->m_mythicFilter ||
-                isSongFilterActive(testObj) ||
-                !testObj->m_searchQuery.empty());
-
-        m_fields->m_retryCount = 0;
-        m_fields->m_currentFilterKey = "";
-
-        if (!m_fields->m_usingFilters) {
-            log::info("[Random] Smart Mode (No Filters) -> Switching to Chaos Logic.");
-            m_fields->m_currentMode = RandomMode::Chaos;
-            m_fields->m_isFetchingLatest = (g_cachedMaxOnlineID == 0);
-            this->startRandomSearch();
-            this->attemptSearch();
+        if (!isUsingFilters(testObj)) {
+            this->abortSearch("Pick some filters first to roll a playlist.");
             return;
         }
 
-        m_fields->m_currentFilterKey = getSearchKey(testObj);
-
-        if (g_filterCache.count(m_fields->m_currentFilterKey)) {
-            int cachedPage = g_filterCache[m_fields->m_currentFilterKey];
-            if (cachedPage == 501 || cachedPage >= 1000) {
-                log::info("[Random] Cache is {} (Infinite/Max). Verifying Glitch Check...", cachedPage);
-                m_fields->m_smartPhase = SmartPhase::Phase3_GlitchCheck;
-            }
-            else {
-                log::info("[Random] Cache HIT! Peeking at Page {}...", cachedPage);
-                m_fields->m_foundMaxPage = cachedPage;
-                m_fields->m_smartPhase = SmartPhase::Phase2_CachePeek;
-            }
-        }
-        else {
-            log::info("[Random] Cache MISS. Starting Fresh Discovery.");
-            m_fields->m_smartPhase = SmartPhase::Phase1_CheckTotal;
-        }
-
-        this->startRandomSearch();
-        this->attemptSearch();
-    }
-
-    void startRandomSearch() {
-        showLoading();
-        m_fields->m_delegate = RandomSearchDelegate::create(
-            [this](GJSearchObject* obj, CCArray* levels) { this->onRandomSuccess(obj, levels); },
-            [this](GJSearchObject* obj) { this->onRandomFailed(obj); }
-        );
+        auto size = (int)Mod::get()->getSettingValue<int64_t>("playlist-size");
+        log::info("[Random] Playlist Search Started ({} levels).", size);
+        m_fields->m_filterSearch = testObj;
+        this->startRoll(createSmartRoll(makeFilterKey(testObj), size));
     }
 
-    void attemptSearch() {
-        if (m_fields->m_currentMode == RandomMode::None) return;
-
-        bool isIdGen = (m_fields->m_currentMode == RandomMode::Chaos ||
-            (m_fields->m_currentMode == RandomMode::Smart && !m_fields->m_usingFilters));
+    void deferredSmartSearch(float) {
+        m_fields->m_currentMode = RandomMode::Smart;
 
-        if (isIdGen) {
-            if (m_fields->m_isFetchingLatest) {
-                auto searchObj = GJSearchObject::create(SearchType::Recent);
-                m_fields->m_delegate->setupSearch(searchObj);
-                GameLevelManager::sharedState()->m_levelManagerDelegate = m_fields->m_delegate;
-                GameLevelManager::sharedState()->getOnlineLevels(searchObj);
-                return;
-            }
-            int randomID = this->getRandomID();
-            auto searchObj = GJSearchObject::create(SearchType::Search, std::to_string(randomID));
-            m_fields->m_delegate->setupSearch(searchObj);
-            GameLevelManager::sharedState()->m_levelManagerDelegate = m_fields->m_delegate;
-            GameLevelManager::sharedState()->getOnlineLevels(searchObj);
+        auto testObj = this->getSearchObject(SearchType::Search, "");
+        if (!testObj) {
+            this->abortSearch("Failed to create search object.");
             return;
         }
 
-        auto searchObj = this->getSearchObject(SearchType::Search, "");
-
-        switch (m_fields->m_smartPhase) {
-        case SmartPhase::Phase1_CheckTotal:
-            searchObj->m_page = 0;
-            log::info("[Random] Phase 1: Checking Page 0...");
-            break;
-        case SmartPhase::Phase2_CachePeek:
-            searchObj->m_page = m_fields->m_foundMaxPage;
-            log::info("[Random] Phase 2: Peeking Cache (Page {})...", m_fields->m_foundMaxPage);
-            break;
-        case SmartPhase::Phase2b_CacheNext:
-            searchObj->m_page = m_fields->m_foundMaxPage + 1;
-            log::info("[Random] Phase 2b: Checking Next Page (Page {})...", searchObj->m_page);
-            break;
-        case SmartPhase::Phase3_GlitchCheck:
-            searchObj->m_page = 1000;
-            log::info("[Random] Phase 3: Glitch Check (Page 1000)...");
-            break;
-        case SmartPhase::Phase4_BinarySearch: {
-            int mid = m_fields->m_searchLow + (m_fields->m_searchHigh - m_fields->m_searchLow) / 2;
-            log::info("[Random] Phase 4: Binary Search [{}-{}] -> Probing {}",
-                m_fields->m_searchLow, m_fields->m_searchHigh, mid);
-            searchObj->m_page = mid;
-            break;
-        }
-        case SmartPhase::Phase5_CalcExact:
-            searchObj->m_page = m_fields->m_foundMaxPage;
-            log::info("[Random] Phase 5: Calculating exact count on Page {}", m_fields->m_foundMaxPage);
-            break;
-        case SmartPhase::Phase6_FetchTarget:
-            searchObj->m_page = m_fields->m_targetPage;
-            log::info("[Random] Phase 6: Fetching Target Page {}", m_fields->m_targetPage);
-            break;
-        default: break;
-        }
-
-        m_fields->m_delegate->setupSearch(searchObj);
-        GameLevelManager::sharedState()->m_levelManagerDelegate = m_fields->m_delegate;
-        GameLevelManager::sharedState()->getOnlineLevels(searchObj);
-    }
+        log::info("[Random] Smart Search Started.");
 
-    void onRandomSuccess(GJSearchObject * searchObj, CCArray * levels) {
-        this->unschedule(schedule_selector(RandomLevelSearch::delayedRetry));
-
-        bool isIdGen = (m_fields->m_currentMode == RandomMode::Chaos ||
-            (m_fields->m_currentMode == RandomMode::Smart && !m_fields->m_usingFilters));
-
-        if (isIdGen) {
-            if (m_fields->m_isFetchingLatest) {
-                m_fields->m_isFetchingLatest = false;
-                if (levels && levels->count() > 0) {
-                    if (auto l = typeinfo_cast<GJGameLevel*>(levels->objectAtIndex(0))) {
-                        if (l->m_levelID > 0) g_cachedMaxOnlineID = l->m_levelID;
-                    }
-                }
-                if (g_cachedMaxOnlineID == 0) g_cachedMaxOnlineID = 100000000;
-                this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.5f);
-                return;
-            }
-            if (levels && levels->count() > 0) this->pickRandomLevel(levels);
-            else this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.5f);
+        if (!isUsingFilters(testObj)) {
+            log::info("[Random] Smart Mode (No Filters) -> Switching to Chaos Logic.");
+            m_fields->m_currentMode = RandomMode::Chaos;
+            this->startChaosRoll();
             return;
         }
 
-        int count = (levels) ? levels->count() : 0;
-        float safeDelay = 0.5f;
-        float searchDelay = 0.75f;
-
-        switch (m_fields->m_smartPhase) {
-        case SmartPhase::Phase1_CheckTotal: {
-            if (count == 0) { this->abortSearch("[Random] No levels found."); return; }
-            int total = searchObj->m_total;
-            if (total > 0 && total < 9990) {
-                log::info("[Random] Trusted Total: {}", total);
-                int maxPage = (total - 1) / 10;
-                int lastPageCount = (total - 1) % 10 + 1;
-                this->prepareTarget(maxPage, lastPageCount);
-                return;
-            }
-            m_fields->m_smartPhase = SmartPhase::Phase3_GlitchCheck;
-            this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), safeDelay);
-            break;
-        }
-
-        case SmartPhase::Phase2_CachePeek: {
-            if (count < 10 && count > 0) {
-                log::info("[Random] Cache Peek: Page not full. Done.");
-                this->prepareTarget(m_fields->m_foundMaxPage, count);
-            }
-            else if (count == 10) {
-                m_fields->m_smartPhase = SmartPhase::Phase2b_CacheNext;
-                this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), safeDelay);
-            }
-            else {
-                log::info("[Random] Cache Peek: Page empty. Searching backwards.");
-                m_fields->m_searchLow = 0;
-                m_fields->m_searchHigh = m_fields->m_foundMaxPage;
-                m_fields->m_smartPhase = SmartPhase::Phase4_BinarySearch;
-                this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), searchDelay);
-            }
-            break;
-        }
-
-        case SmartPhase::Phase2b_CacheNext: {
-            if (count == 0) {
-                log::info("[Random] Next page empty. Original cache was end (10 items).");
-                this->prepareTarget(m_fields->m_foundMaxPage, 10);
-            }
-            else if (count < 10) {
-                log::info("[Random] New levels found (Count {}). Updated end.", count);
-                this->prepareTarget(m_fields->m_foundMaxPage + 1, count);
-            }
-            else {
-                if (searchObj->m_page >= 1000) {
-                    log::info("[Random] Hit Page 1000+ via Cache (Infinite). Capping at 501.");
-                    this->prepareTarget(501, 10);
-                    return;
-                }
-                log::info("[Random] Next page full. Expanding search to Limit (1000).");
-                m_fields->m_searchLow = m_fields->m_foundMaxPage + 1;
-                m_fields->m_searchHigh = 1000;
-                m_fields->m_smartPhase = SmartPhase::Phase4_BinarySearch;
-                this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), searchDelay);
-            }
-            break;
-        }
-
-        case SmartPhase::Phase3_GlitchCheck: {
-            if (count > 0) {
-                log::info("[Random] Glitch Detected (Page 1000 has levels). Capping 501.");
-                this->prepareTarget(501, 10);
-            }
-            else {
-                log::info("[Random] Finite Mode. Binary Search.");
-                m_fields->m_searchLow = 0;
-                m_fields->m_searchHigh = 1000;
-                m_fields->m_smartPhase = SmartPhase::Phase4_BinarySearch;
-                this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), searchDelay);
-            }
-            break;
-        }
-
-        case SmartPhase::Phase4_BinarySearch: {
-            int searchedPage = searchObj->m_page;
-            if (count > 0) {
-                if (searchedPage >= 1000) {
-                    log::info("[Random] Binary Search hit 1000+ (Infinite). Capping at 501.");
-                    this->prepareTarget(501, 10);
-                    return;
-                }
-                m_fields->m_searchLow = searchedPage;
-            }
-            else {
-                m_fields->m_searchHigh = searchedPage;
-            }
-
-            if (m_fields->m_searchHigh - m_fields->m_searchLow <= 1) {
-                m_fields->m_foundMaxPage = m_fields->m_searchLow;
-                m_fields->m_smartPhase = SmartPhase::Phase5_CalcExact;
-            }
-            this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), searchDelay);
-            break;
-        }
-
-        case SmartPhase::Phase5_CalcExact: {
-            if (count == 0) {
-                if (m_fields->m_foundMaxPage > 0) {
-                    m_fields->m_foundMaxPage--;
-                    this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), safeDelay);
-                    return;
-                }
-                this->abortSearch("[Random] Final page empty."); return;
-            }
-            this->prepareTarget(m_fields->m_foundMaxPage, count);
-            break;
-        }
-
-        case SmartPhase::Phase6_FetchTarget: {
-            int index = m_fields->m_targetSlot;
+        auto filterKey = makeFilterKey(testObj);
+        m_fields->m_filterSearch = testObj;
+        Preroller::get().setSmartSource(filterKey, testObj);
 
-            if (count == 0) {
-                log::info("[Random] Fast Path failed (Empty Page). Invalidating cache.");
-                g_filterCache.erase(m_fields->m_currentFilterKey);
-                Mod::get()->setSavedValue("filter_cache", g_filterCache);
-                m_fields->m_smartPhase = SmartPhase::Phase1_CheckTotal;
-                this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), safeDelay);
-                return;
-            }
-
-            if (index >= count) index = count - 1;
-
-            if (index >= 0) {
-                auto lvl = typeinfo_cast<GJGameLevel*>(levels->objectAtIndex(index));
-                if (lvl) this->openLevelPage(lvl);
-                else this->abortSearch("[Random] Level object was null.");
-            }
-            else {
-                this->abortSearch("[Random] Invalid slot index.");
-            }
-            break;
-        }
+        if (auto level = Preroller::get().popSmart(filterKey)) {
+            log::info("[Random] Using pre-rolled Smart level.");
+            this->openLevelPage(level, std::nullopt);
+            return;
         }
+        this->startRoll(createSmartRoll(filterKey));
     }
 
-    void onRandomFailed(GJSearchObject * searchObj) {
-        this->unschedule(schedule_selector(RandomLevelSearch::delayedRetry));
+    void startRoll(std::unique_ptr<RollEngine> engine) {
+        showLoading();
 
-        if (m_fields->m_smartPhase == SmartPhase::Phase2_CachePeek) {
-            log::info("[Random] Cache Peek Failed. Searching Backwards.");
-            m_fields->m_searchLow = 0;
-            m_fields->m_searchHigh = m_fields->m_foundMaxPage;
-            m_fields->m_smartPhase = SmartPhase::Phase4_BinarySearch;
-            this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.75f);
-            return;
-        }
+        if (!m_fields->m_driver) {
+            m_fields->m_fetcher = createLevelFetcher(
+                [this](PageRequest const& request) { return createRequestObject(request, m_fields->m_filterSearch); }
+            );
+            m_fields->m_timer = CocosTimer::create();
+            m_fields->m_driver = std::make_unique<RollDriver>(*m_fields->m_fetcher, *m_fields->m_timer);
+            m_fields->m_driver->setScheduler(&requestScheduler());
+        }
+
+        m_fields->m_fetcher->clearPages();
+        engine->setNoteSink([](std::string const& message) { log::info("[Random] {}", message); });
+        m_fields->m_engine = std::move(engine);
+        m_fields->m_driver->run(*m_fields->m_engine, [this](RollOutcome const& outcome) {
+            this->onRollFinished(outcome);
+        });
+    }
 
-        if (m_fields->m_smartPhase == SmartPhase::Phase2b_CacheNext) {
-            log::info("[Random] Next page failed. Using Cached Page (10 items).");
-            this->prepareTarget(m_fields->m_foundMaxPage, 10);
-            return;
-        }
+    void onRollFinished(RollOutcome const& outcome) {
+        log::info("[Random] Roll finished: {} requests, {} stored pages in {:.2f}s ({:.2f}s pacing, rate {:.2f}/s)",
+            outcome.stats.requests, outcome.stats.localHits, outcome.stats.elapsed(), outcome.stats.delayTime, requestScheduler().rate());
+        saveScheduler();
+        this->recordOutcome(outcome);
 
-        if (m_fields->m_smartPhase == SmartPhase::Phase3_GlitchCheck) {
-            m_fields->m_searchLow = 0;
-            m_fields->m_searchHigh = 1000;
-            m_fields->m_smartPhase = SmartPhase::Phase4_BinarySearch;
-            this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.75f);
+        if (!outcome.success) {
+            this->abortSearch(outcome.reason);
             return;
         }
 
-        if (m_fields->m_smartPhase == SmartPhase::Phase4_BinarySearch) {
-            int failedPage = searchObj->m_page;
-            m_fields->m_searchHigh = failedPage;
-            if (m_fields->m_searchHigh - m_fields->m_searchLow <= 1) {
-                m_fields->m_foundMaxPage = m_fields->m_searchLow;
-                m_fields->m_smartPhase = SmartPhase::Phase5_CalcExact;
+        if (m_fields->m_currentMode == RandomMode::Playlist) {
+            g_playlist.clear();
+            for (auto const& pick : outcome.picks) {
+                if (auto level = m_fields->m_fetcher->levelAt(pick.page, pick.slot)) g_playlist.push_back(level);
             }
-            this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.75f);
-            return;
-        }
-
-        if (m_fields->m_currentMode == RandomMode::Chaos) {
-            this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.5f);
+            if (g_playlist.empty()) {
+                this->abortSearch("Level object was null.");
+                return;
+            }
+            Ref<GJGameLevel> first = g_playlist.front();
+            g_playlist.pop_front();
+            log::info("[Random] Playlist ready: {} levels.", g_playlist.size() + 1);
+            this->openLevelPage(first, outcome);
             return;
         }
 
-        m_fields->m_retryCount++;
-        if (m_fields->m_retryCount > 5) {
-            this->abortSearch("[Random] Connection Failed or Timed Out.");
+        auto lvl = m_fields->m_fetcher->levelAt(outcome.page, outcome.slot);
+        if (!lvl) {
+            this->abortSearch("Level object was null.");
             return;
         }
-        this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 1.0f);
+        this->openLevelPage(lvl, outcome);
     }
 
-    void prepareTarget(int maxPageInclusive, int levelsOnMaxPage) {
-        long long totalLevels = ((long long)maxPageInclusive * 10) + levelsOnMaxPage;
-
-        if (m_fields->m_usingFilters) {
-            g_filterCache[m_fields->m_currentFilterKey] = maxPageInclusive;
-            Mod::get()->setSavedValue("filter_cache", g_filterCache);
+    void recordOutcome(RollOutcome const& outcome) {
+        auto mode = m_fields->m_currentMode;
+        if (mode == RandomMode::Chaos || !m_fields->m_filterSearch) {
+            recordRoll("Chaos", nullptr, outcome);
+            return;
         }
-
-        int globalIndex = generateRandomInt(0, (int)totalLevels - 1);
-
-        m_fields->m_targetPage = globalIndex / 10;
-        m_fields->m_targetSlot = globalIndex % 10;
-
-        m_fields->m_smartPhase = SmartPhase::Phase6_FetchTarget;
-        this->scheduleOnce(schedule_selector(RandomLevelSearch::delayedRetry), 0.1f);
+        auto filterKey = makeFilterKey(m_fields->m_filterSearch);
+        recordRoll(mode == RandomMode::Playlist ? "Playlist" : "Smart", &filterKey, outcome);
     }
 
     void abortSearch(std::string reason) {
-        log::error("{}", reason);
+        log::error("[Random] {}", reason);
         this->stopSearchLogic();
 
         auto alert = FLAlertLayer::create("Random Search", reason.c_str(), "OK");
         alert->show();
     }
 
-    void delayedRetry(float) { this->attemptSearch(); }
-
-    void pickRandomLevel(CCArray * levels) {
-        if (!levels || levels->count() == 0) { this->abortSearch("No levels found."); return; }
-        int slot = generateRandomInt(0, levels->count() - 1);
-
-        this->openLevelPage(typeinfo_cast<GJGameLevel*>(levels->objectAtIndex(slot)));
-    }
-
-    void openLevelPage(GJGameLevel * level) {
+    void openLevelPage(GJGameLevel * level, std::optional<RollOutcome> const& outcome) {
         if (!level) return;
 
         log::info("=========================================");
@@ -610,24 +362,17 @@ class $modify(RandomLevelSearch, LevelSearchLayer) {
         log::info("[Random] ID:   {}", level->m_levelID.value());
 
         if (m_fields->m_currentMode == RandomMode::Chaos) {
-            log::info("[Random] Max Recents ID: {}", g_cachedMaxOnlineID);
+            log::info("[Random] Max Recents ID: {}", cachedMaxOnlineID());
         }
-        else {
-            log::info("[Random] Page: {}", m_fields->m_targetPage + 1);
-            log::info("[Random] Slot: {}", m_fields->m_targetSlot + 1);
+        else if (outcome) {
+            log::info("[Random] Page: {}", outcome->page + 1);
+            log::info("[Random] Slot: {}", outcome->slot + 1);
         }
         log::info("=========================================");
 
+        if (m_fields->m_currentMode != RandomMode::Playlist) g_playlist.clear();
         this->stopSearchLogic();
-        g_enteredViaRandom = true;
-        auto saved = GameLevelManager::sharedState()->getSavedLevel(level->m_levelID);
-        auto scene = LevelInfoLayer::scene(saved ? saved : level, false);
-        CCDirector::sharedDirector()->replaceScene(CCTransitionFade::create(0.5f, scene));
-    }
-
-    int getRandomID() {
-        int max = (g_cachedMaxOnlineID > 0) ? g_cachedMaxOnlineID : 100000000;
-        return generateRandomInt(128, max);
+        openRandomLevel(level);
     }
 
     void stopSearchLogic() {
@@ -637,23 +382,18 @@ class $modify(RandomLevelSearch, LevelSearchLayer) {
             m_fields->m_loadingCircle = nullptr;
         }
 
-        if (m_fields->m_delegate) {
-            m_fields->m_delegate->invalidate();
+        if (m_fields->m_driver) {
+            m_fields->m_driver->cancel();
         }
+        m_fields->m_engine = nullptr;
 
-        if (GameLevelManager::sharedState()->m_levelManagerDelegate == m_fields->m_delegate) {
-            GameLevelManager::sharedState()->m_levelManagerDelegate = nullptr;
-        }
-
-        m_fields->m_delegate = nullptr;
-
-        this->unschedule(schedule_selector(RandomLevelSearch::delayedRetry));
         this->unschedule(schedule_selector(RandomLevelSearch::deferredSmartSearch));
         this->unschedule(schedule_selector(RandomLevelSearch::deferredChaosSearch));
+        this->unschedule(schedule_selector(RandomLevelSearch::deferredPlaylistSearch));
     }
 
     void onExit() {
         this->stopSearchLogic();
         LevelSearchLayer::onExit();
     }
-};
\ No newline at end of file
+};